@@ -0,0 +1,183 @@
+#include "LCDCallSiteProfile.h"
+#ifdef ARDUINO_CI_COMPILATION_MOCKS
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#if defined(__linux__)
+#include <fcntl.h>
+#include <link.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+bool moreExpensive(const LCDCallSiteProfile::Site &a,
+                   const LCDCallSiteProfile::Site &b) {
+  if (a.micros != b.micros) {
+    return a.micros > b.micros;
+  }
+  return a.calls > b.calls;
+}
+
+#if defined(__linux__)
+// the first line addr2line prints, or "" if it can't be run. It is spawned
+// directly rather than through a shell, so the file name needs no quoting.
+String runAddr2line(const char *file, uintptr_t offset, bool function) {
+  char address[24];
+  snprintf(address, sizeof(address), "0x%lx", (unsigned long)offset);
+  const char *functionArgs[] = {"addr2line", "-C", "-f", "-e",
+                                file,        address, nullptr};
+  const char *positionArgs[] = {"addr2line", "-e", file, address, nullptr};
+  int fds[2];
+  if (pipe(fds)) {
+    return "";
+  }
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+  posix_spawn_file_actions_addclose(&actions, fds[0]);
+  posix_spawn_file_actions_addclose(&actions, fds[1]);
+  posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null",
+                                   O_WRONLY, 0);
+  pid_t pid;
+  int failed = posix_spawnp(
+      &pid, "addr2line", &actions, nullptr,
+      (char *const *)(function ? functionArgs : positionArgs), environ);
+  posix_spawn_file_actions_destroy(&actions);
+  close(fds[1]);
+  char line[256];
+  size_t used = 0;
+  ssize_t got;
+  while (!failed && used < sizeof(line) - 1 &&
+         (got = read(fds[0], line + used, sizeof(line) - 1 - used)) > 0) {
+    used += got;
+  }
+  line[used] = '\0';
+  close(fds[0]);
+  if (!failed) {
+    waitpid(pid, nullptr, 0);
+  }
+  // without the newline or a " (discriminator n)"
+  line[strcspn(line, "\n")] = '\0';
+  char *note = strstr(line, " (");
+  if (note && !function) {
+    *note = '\0';
+  }
+  return line;
+}
+
+// the loaded file holding an address, and where it was loaded
+struct Module {
+  uintptr_t address;
+  const char *file;
+  uintptr_t base;
+};
+
+int findModule(struct dl_phdr_info *info, size_t, void *data) {
+  Module *module = (Module *)data;
+  for (int i = 0; i < info->dlpi_phnum; ++i) {
+    const ElfW(Phdr) &segment = info->dlpi_phdr[i];
+    uintptr_t start = info->dlpi_addr + segment.p_vaddr;
+    if (segment.p_type == PT_LOAD && module->address >= start &&
+        module->address < start + segment.p_memsz) {
+      module->file = info->dlpi_name;
+      module->base = info->dlpi_addr;
+      return 1;
+    }
+  }
+  return 0;
+}
+#endif
+
+} // namespace
+
+std::vector<LCDCallSiteProfile::Site> LCDCallSiteProfile::getSites() const {
+  std::vector<Site> sites;
+  sites.reserve(_used);
+  for (size_t i = 0; i < CAPACITY; ++i) {
+    if (_table[i].address) {
+      sites.push_back(_table[i]);
+    }
+  }
+  std::sort(sites.begin(), sites.end(), moreExpensive);
+  return sites;
+}
+
+String LCDCallSiteProfile::getReport(size_t top) const {
+  std::vector<Site> sites = getSites();
+  unsigned long long total = 0;
+  for (size_t i = 0; i < sites.size(); ++i) {
+    total += sites[i].micros;
+  }
+  String report = "    bus us  share    calls   pulses  call site\n";
+  char line[64];
+  for (size_t i = 0; i < sites.size() && (!top || i < top); ++i) {
+    const Site &site = sites[i];
+    snprintf(line, sizeof(line), "%10lu %5.1f%% %8lu %8lu  ", site.micros,
+             total ? 100.0 * site.micros / total : 0.0, site.calls,
+             site.pulses);
+    report += line;
+    report += describe(site.address);
+    report += '\n';
+  }
+  if (_dropped) {
+    snprintf(line, sizeof(line), "%lu calls from further sites not counted\n",
+             _dropped);
+    report += line;
+  }
+  return report;
+}
+
+String LCDCallSiteProfile::describe(const void *address) {
+  char text[64];
+#if !defined(__linux__)
+  // no ELF modules or addr2line to look the address up with
+  snprintf(text, sizeof(text), "%p", address);
+  return text;
+#else
+  // dl_iterate_phdr() rather than dladdr(), which needs -ldl before glibc
+  // 2.34, and this file is linked into every test
+  Module module = {(uintptr_t)address, nullptr, 0};
+  if (!dl_iterate_phdr(findModule, &module)) {
+    snprintf(text, sizeof(text), "%p", address);
+    return text;
+  }
+  // return addresses point after the call; look up the call itself.
+  // addr2line wants addresses relative to the load address, which is 0
+  // for executables that aren't position independent.
+  uintptr_t offset = module.address - 1 - module.base;
+  // the executable is listed without a name
+  char executable[256];
+  if (!module.file[0]) {
+    ssize_t length =
+        readlink("/proc/self/exe", executable, sizeof(executable) - 1);
+    executable[length < 0 ? 0 : length] = '\0';
+    module.file = executable;
+  }
+  String function = runAddr2line(module.file, offset, true);
+  if (function.length() == 0 || function == "??") {
+    snprintf(text, sizeof(text), "%s+0x%lx", module.file,
+             (unsigned long)offset);
+    return text;
+  }
+  String position = runAddr2line(module.file, offset, false);
+  if (position.length() && position.indexOf("??") < 0) {
+    function += " at ";
+    // the file name is enough
+    int slash = position.lastIndexOf('/');
+    function += slash < 0 ? position : position.substring(slash + 1);
+  }
+  return function;
+#endif
+}
+
+void LCDCallSiteProfile::reset() {
+  memset(_table, 0, sizeof(_table));
+  _used = 0;
+  _dropped = 0;
+  _pulses = 0;
+}
+
+#endif
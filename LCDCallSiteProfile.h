@@ -0,0 +1,93 @@
+#pragma once
+#include "Arduino.h"
+#ifdef ARDUINO_CI_COMPILATION_MOCKS
+#include "ci/ObservableDataStream.h"
+#include <stdint.h>
+#include <vector>
+
+// Bus time per call site. With lcd.profileTo(&profile), every call into
+// the display from outside it is charged, by return address, with the
+// simulated time it took (its transfers and delays) and its enable pulses.
+// Sites are kept in a fixed open-addressing table, so collecting costs a
+// hash and a few additions per call; names are only looked up for the
+// report.
+//
+//   LCDCallSiteProfile profile;
+//   lcd.profileTo(&profile);
+//   ... run the simulation ...
+//   Serial.print(profile.getReport());
+//
+// The site of print() and println() is their caller when they are called
+// on a LiquidCrystal_CI; through a Print reference it is the library's own
+// Print code. Calls queued in concurrent mode are charged to the code that
+// queued them when they are applied; print() is queued, and so counted, a
+// character at a time. Names come from addr2line; build with -g for file
+// and line numbers in the report.
+class LCDCallSiteProfile : public DataStreamObserver {
+public:
+  static const size_t CAPACITY = 1024; // a power of two
+
+  struct Site {
+    const void *address;
+    unsigned long calls, pulses, micros;
+  };
+
+  LCDCallSiteProfile() : DataStreamObserver(false, false) { reset(); }
+
+  void add(const void *site, unsigned long micros, unsigned long pulses) {
+    uint64_t hash = (uint64_t)(uintptr_t)site * 0x9E3779B97F4A7C15ULL;
+    // the top bits, as many as index CAPACITY entries
+    size_t i = hash >> (64 - log2(CAPACITY));
+    while (_table[i].address != site) {
+      if (!_table[i].address) {
+        // at most three quarters full, to keep probes short
+        if (_used >= CAPACITY / 4 * 3) {
+          ++_dropped;
+          return;
+        }
+        _table[i].address = site;
+        ++_used;
+        break;
+      }
+      i = (i + 1) & (CAPACITY - 1);
+    }
+    Site &entry = _table[i];
+    ++entry.calls;
+    entry.pulses += pulses;
+    entry.micros += micros;
+  }
+
+  // by bus time, most expensive first
+  std::vector<Site> getSites() const;
+  // calls not counted because the table was full
+  unsigned long getDropped() const { return _dropped; }
+  // One line per site, most expensive first, with its share of the total
+  // and where it is: function, and file and line where addr2line finds
+  // them. top 0 lists every site.
+  String getReport(size_t top = 10) const;
+  // the function and source position of a code address, as far as known;
+  // outside Linux, just the address
+  static String describe(const void *address);
+  void reset();
+
+  unsigned long getPulses() const { return _pulses; }
+  virtual void onBit(bool aBit) {
+    if (aBit) {
+      ++_pulses;
+    }
+  }
+  virtual String observerName() const { return "LCDCallSiteProfile"; }
+
+private:
+  static constexpr unsigned log2(size_t n) {
+    return n > 1 ? 1 + log2(n / 2) : 0;
+  }
+  static_assert((CAPACITY & (CAPACITY - 1)) == 0,
+                "CAPACITY must be a power of two");
+
+  Site _table[CAPACITY];
+  size_t _used;
+  unsigned long _dropped, _pulses;
+};
+
+#endif
@@ -0,0 +1,86 @@
+#include "LCDCharset.h"
+#include "LCDCharsetTables.h"
+
+namespace {
+
+// the parts of toRom() common to both ROMs; in the tables, 0 means no glyph
+int16_t lookup(uint32_t codePoint, const uint8_t *pageIndex,
+               const uint8_t (*pages)[256]) {
+  if (codePoint < 0x20) {
+    return codePoint;
+  }
+  if (codePoint > 0xFFFF) {
+    return -1;
+  }
+  if (codePoint == 0x24EA) {
+    return 0; // ⓪
+  }
+  if (codePoint >= 0x2460 && codePoint <= 0x2466) {
+    return codePoint - 0x2460 + 1; // ① to ⑦
+  }
+  uint8_t high = codePoint >> 8, low = codePoint & 0xFF;
+  uint8_t code = 0;
+  uint8_t page = pgm_read_byte(&pageIndex[high]);
+  if (page) {
+    code = pgm_read_byte(&pages[page - 1][low]);
+  }
+  return code ? code : -1;
+}
+
+uint8_t copyUTF8(const char *text, char utf8[6]) {
+  uint8_t length = 0;
+  while ((utf8[length] = pgm_read_byte(&text[length]))) {
+    ++length;
+  }
+  return length;
+}
+
+} // namespace
+
+template <> int16_t LCDCharset<LCD_ROM_A00>::toRom(uint32_t codePoint) {
+  return lookup(codePoint, LCD_A00_PAGE_INDEX, LCD_A00_PAGES);
+}
+
+template <> int16_t LCDCharset<LCD_ROM_A02>::toRom(uint32_t codePoint) {
+  return lookup(codePoint, LCD_A02_PAGE_INDEX, LCD_A02_PAGES);
+}
+
+template <>
+uint8_t LCDCharset<LCD_ROM_A00>::toUTF8(uint8_t code, char utf8[6]) {
+  return copyUTF8(LCD_A00_UTF8[code], utf8);
+}
+
+template <>
+uint8_t LCDCharset<LCD_ROM_A02>::toUTF8(uint8_t code, char utf8[6]) {
+  return copyUTF8(LCD_A02_UTF8[code], utf8);
+}
+
+size_t LCDUTF8Print::write(uint8_t value) {
+  if (_remaining) {
+    if ((value & 0xC0) == 0x80) {
+      _codePoint = (_codePoint << 6) | (value & 0x3F);
+      if (--_remaining == 0) {
+        emit(_codePoint);
+      }
+      return 1;
+    }
+    // the sequence was cut short; start over with this byte
+    _remaining = 0;
+    _out.write(_fallback);
+  }
+  if (value < 0x80) {
+    emit(value);
+  } else if ((value & 0xE0) == 0xC0) {
+    _codePoint = value & 0x1F;
+    _remaining = 1;
+  } else if ((value & 0xF0) == 0xE0) {
+    _codePoint = value & 0x0F;
+    _remaining = 2;
+  } else if ((value & 0xF8) == 0xF0) {
+    _codePoint = value & 0x07;
+    _remaining = 3;
+  } else {
+    _out.write(_fallback);
+  }
+  return 1;
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include "Arduino.h"
+
+// The two character ROMs HD44780 controllers ship with: A00 (Japanese, with
+// katakana) and A02 (European, with Latin-1 and Cyrillic).
+enum LCDRom { LCD_ROM_A00, LCD_ROM_A02 };
+
+// Translation between Unicode and a character ROM, through tables generated
+// by extras/charset/gen_charset_tables.py. Both directions are a table
+// lookup per character. The ROM is a template parameter so that a sketch
+// only links the tables of the ROM it uses.
+template <LCDRom ROM> class LCDCharset {
+public:
+  // ROM code for a code point, or -1 if the ROM has no such glyph. Codes
+  // below 0x20 pass through unchanged, so custom characters still work, and
+  // ⓪ to ⑦ select them too.
+  static int16_t toRom(uint32_t codePoint);
+  // UTF-8 for a ROM code, NUL-terminated, at most 5 bytes; returns the
+  // length. Custom characters read as ⓪ to ⑦ and codes the ROM leaves
+  // empty as U+FFFD.
+  static uint8_t toUTF8(uint8_t code, char utf8[6]);
+};
+
+template <> int16_t LCDCharset<LCD_ROM_A00>::toRom(uint32_t codePoint);
+template <> int16_t LCDCharset<LCD_ROM_A02>::toRom(uint32_t codePoint);
+template <> uint8_t LCDCharset<LCD_ROM_A00>::toUTF8(uint8_t code, char utf8[6]);
+template <> uint8_t LCDCharset<LCD_ROM_A02>::toUTF8(uint8_t code, char utf8[6]);
+
+// Decodes UTF-8 written to it and passes each code point to emit(); the
+// ROM-specific part of LCDCharsetPrint.
+class LCDUTF8Print : public Print {
+public:
+  virtual size_t write(uint8_t value);
+  using Print::write;
+
+protected:
+  LCDUTF8Print(Print &out, uint8_t fallback)
+      : _out(out), _fallback(fallback), _codePoint(0), _remaining(0) {}
+  virtual void emit(uint32_t codePoint) = 0;
+
+  Print &_out;
+  uint8_t _fallback;
+
+private:
+  uint32_t _codePoint;
+  uint8_t _remaining;
+};
+
+// Prints UTF-8 text on a display with the given ROM: wrap the display and
+// print through the wrapper.
+//
+//   LCDCharsetPrint<LCD_ROM_A02> text(lcd);
+//   text.print("Température: 21°C");
+//
+// Characters the ROM lacks print as the fallback, as do malformed
+// sequences.
+template <LCDRom ROM = LCD_ROM_A00>
+class LCDCharsetPrint : public LCDUTF8Print {
+public:
+  LCDCharsetPrint(Print &out, uint8_t fallback = '?')
+      : LCDUTF8Print(out, fallback) {}
+
+protected:
+  virtual void emit(uint32_t codePoint) {
+    int16_t code = LCDCharset<ROM>::toRom(codePoint);
+    _out.write(code < 0 ? _fallback : (uint8_t)code);
+  }
+};
@@ -0,0 +1,96 @@
+#include "LCDFleet.h"
+#ifdef ARDUINO_CI_COMPILATION_MOCKS
+#include "LCDScreenKernels.h"
+#include <string.h>
+
+LCDFleet::LCDFleet(uint32_t devices, uint8_t cols, uint8_t rows)
+    : _devices(devices), _cols(cols), _rows(rows),
+      _grid((size_t)devices * rows * cols, ' '), _col(devices, 0),
+      _row(devices, 0), _flags(devices, 0), _cgram((size_t)devices * 64, 0) {}
+
+void LCDFleet::clear(uint32_t device) {
+  memset(&_grid[(size_t)device * _rows * _cols], ' ', _rows * _cols);
+}
+
+// as LiquidCrystal_CI: with autoscroll the text left of the cursor moves
+// left and the character lands just before the cursor
+void LCDFleet::write(uint32_t device, uint8_t value) {
+  uint8_t &col = _col[device];
+  uint8_t *row = &_grid[((size_t)device * _rows + _row[device]) * _cols];
+  if (_flags[device] & FLAG_AUTOSCROLL) {
+    if (col == 0) {
+      return;
+    }
+    // only the visible part of the row is kept
+    size_t shifted = col - 1 < _cols ? col - 1 : _cols - 1;
+    memmove(row, row + 1, shifted);
+    --col;
+  }
+  if (col < _cols) {
+    row[col] = value;
+  }
+  // the cursor may run on into the part of DDRAM that isn't shown
+  if (col < 80) {
+    ++col;
+  }
+}
+
+std::vector<uint32_t> LCDFleet::find(const char *text) const {
+  std::vector<uint32_t> found;
+  size_t length = strlen(text);
+  if (length == 0 || length > _cols || _grid.empty()) {
+    return found;
+  }
+  // one pass over the whole grid, rejecting matches that span two rows
+  const uint8_t *grid = &_grid[0];
+  size_t screen = (size_t)_rows * _cols;
+  size_t size = _grid.size();
+  size_t at = 0;
+  while (at < size) {
+    size_t offset = LCDScreenKernels::find(grid + at, size - at,
+                                           (const uint8_t *)text, length);
+    if (offset == LCDScreenKernels::NOT_FOUND) {
+      break;
+    }
+    at += offset;
+    if (at % _cols + length <= _cols) {
+      uint32_t device = at / screen;
+      found.push_back(device);
+      at = (size_t)(device + 1) * screen;
+    } else {
+      ++at;
+    }
+  }
+  return found;
+}
+
+std::vector<uint32_t>
+LCDFleet::findMatching(const ScreenPattern &pattern) const {
+  std::vector<uint32_t> found;
+  if (!pattern.isValid() || pattern.getRows() > _rows) {
+    return found;
+  }
+  for (uint32_t device = 0; device < _devices; ++device) {
+    bool matched = true;
+    for (int row = 0; matched && row < pattern.getRows(); ++row) {
+      matched = pattern.matchesRow(row, getRow(device, row), _cols);
+    }
+    if (matched) {
+      found.push_back(device);
+    }
+  }
+  return found;
+}
+
+std::vector<uint32_t> LCDFleet::findWithFlags(uint8_t mask,
+                                              uint8_t flags) const {
+  std::vector<uint32_t> found;
+  for (uint32_t device = 0; device < _devices; ++device) {
+    if ((_flags[device] & mask) == flags) {
+      found.push_back(device);
+    }
+  }
+  return found;
+}
+
+#endif
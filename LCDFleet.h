@@ -0,0 +1,117 @@
+#pragma once
+#include "Arduino.h"
+#ifdef ARDUINO_CI_COMPILATION_MOCKS
+#include "ScreenPattern.h"
+#include <vector>
+
+class LCDFleetDisplay;
+
+// Screen state for thousands of simulated devices, stored as structure of
+// arrays: every device's text in one contiguous grid, and cursors, flags and
+// custom characters in arrays of their own, so batch queries scan dense
+// memory and a device costs rows * cols + 67 bytes. Devices don't drive the
+// pin mocks (which are shared by the whole process), so there is no limit
+// of one display per rs pin as with LiquidCrystal_CI.
+//
+//   LCDFleet fleet(10000, 16, 2);
+//   LCDFleetDisplay lcd = fleet.display(42); // a Print, like LiquidCrystal
+//   lcd.print("ERR 7");
+//   std::vector<uint32_t> failing = fleet.find("ERR");
+//
+// The text follows the same model as LiquidCrystal_CI, except that rows are
+// always full width and blank cells are spaces.
+class LCDFleet {
+public:
+  enum {
+    FLAG_DISPLAY = 1,
+    FLAG_CURSOR = 2,
+    FLAG_BLINK = 4,
+    FLAG_AUTOSCROLL = 8
+  };
+
+  LCDFleet(uint32_t devices, uint8_t cols, uint8_t rows);
+
+  uint32_t size() const { return _devices; }
+  uint8_t getCols() const { return _cols; }
+  uint8_t getRows() const { return _rows; }
+  LCDFleetDisplay display(uint32_t device);
+
+  // state of one device
+  const uint8_t *getRow(uint32_t device, uint8_t row) const {
+    return &_grid[((size_t)device * _rows + row) * _cols];
+  }
+  String getLine(uint32_t device, uint8_t row) const {
+    return String(std::string((const char *)getRow(device, row), _cols));
+  }
+  uint8_t getCursorCol(uint32_t device) const { return _col[device]; }
+  uint8_t getCursorRow(uint32_t device) const { return _row[device]; }
+  uint8_t getFlags(uint32_t device) const { return _flags[device]; }
+  const uint8_t *getCustomCharacter(uint32_t device, uint8_t location) const {
+    return &_cgram[(size_t)device * 64 + (location & 7) * 8];
+  }
+
+  // batch queries, returning device numbers in ascending order
+  std::vector<uint32_t> find(const char *text) const;
+  std::vector<uint32_t> findMatching(const ScreenPattern &pattern) const;
+  std::vector<uint32_t> findWithFlags(uint8_t mask, uint8_t flags) const;
+
+private:
+  friend class LCDFleetDisplay;
+  uint32_t _devices;
+  uint8_t _cols, _rows;
+  std::vector<uint8_t> _grid;
+  std::vector<uint8_t> _col, _row, _flags;
+  std::vector<uint8_t> _cgram;
+
+  void write(uint32_t device, uint8_t value);
+  void clear(uint32_t device);
+};
+
+// One device of a fleet, with the display part of the LiquidCrystal API.
+// Cheap to copy; it is only a reference to the fleet's arrays.
+class LCDFleetDisplay : public Print {
+public:
+  LCDFleetDisplay(LCDFleet &fleet, uint32_t device)
+      : _fleet(&fleet), _device(device) {}
+
+  void clear() { _fleet->clear(_device); }
+  void home() { setCursor(0, 0); }
+  void setCursor(uint8_t col, uint8_t row) {
+    _fleet->_col[_device] = col;
+    _fleet->_row[_device] = row < _fleet->_rows ? row : _fleet->_rows - 1;
+  }
+  void display() { set(LCDFleet::FLAG_DISPLAY, true); }
+  void noDisplay() { set(LCDFleet::FLAG_DISPLAY, false); }
+  void cursor() { set(LCDFleet::FLAG_CURSOR, true); }
+  void noCursor() { set(LCDFleet::FLAG_CURSOR, false); }
+  void blink() { set(LCDFleet::FLAG_BLINK, true); }
+  void noBlink() { set(LCDFleet::FLAG_BLINK, false); }
+  void autoscroll() { set(LCDFleet::FLAG_AUTOSCROLL, true); }
+  void noAutoscroll() { set(LCDFleet::FLAG_AUTOSCROLL, false); }
+  void createChar(uint8_t location, const uint8_t charmap[]) {
+    memcpy(&_fleet->_cgram[(size_t)_device * 64 + (location & 7) * 8],
+           charmap, 8);
+  }
+  virtual size_t write(uint8_t value) {
+    _fleet->write(_device, value);
+    return 1;
+  }
+  using Print::write;
+
+  uint32_t getDevice() const { return _device; }
+
+private:
+  LCDFleet *_fleet;
+  uint32_t _device;
+
+  void set(uint8_t flag, bool on) {
+    uint8_t &flags = _fleet->_flags[_device];
+    flags = on ? (flags | flag) : (flags & ~flag);
+  }
+};
+
+inline LCDFleetDisplay LCDFleet::display(uint32_t device) {
+  return LCDFleetDisplay(*this, device);
+}
+
+#endif
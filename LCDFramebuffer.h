@@ -0,0 +1,74 @@
+#pragma once
+// Layout of the shared framebuffer that LiquidCrystal_CI::publishTo() keeps
+// up to date in a memory-mapped file, for viewers in other processes. This
+// header depends only on the C++ standard library, so a viewer can include
+// it without the Arduino mocks.
+//
+// The frame is guarded by a sequence lock: the writer makes the sequence odd,
+// rewrites the frame in place and makes it even again. A reader copies the
+// frame and retries if the sequence was odd or changed meanwhile, so the
+// writer never waits for readers.
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <thread>
+
+enum {
+  LCD_FRAME_DISPLAY = 1,
+  LCD_FRAME_CURSOR = 2,
+  LCD_FRAME_BLINK = 4,
+  LCD_FRAME_AUTOSCROLL = 8
+};
+
+struct LCDFrame {
+  uint64_t micros;  // virtual time of the last update
+  uint32_t updates; // calls published so far
+  uint8_t rsPin;
+  uint8_t cols, rows;
+  uint8_t cursorCol, cursorRow;
+  uint8_t flags; // LCD_FRAME_*
+  uint8_t shift; // display shift, 0 to 39
+  uint8_t reserved;
+  uint8_t grid[4][40]; // blank cells are spaces
+  uint8_t cgram[8][8];
+};
+
+struct LCDFramebuffer {
+  char magic[4]; // "LCD1"
+  uint32_t size; // sizeof(LCDFramebuffer)
+  std::atomic<uint32_t> sequence;
+  uint32_t reserved;
+  LCDFrame frame;
+
+  bool isValid() const {
+    return !memcmp(magic, "LCD1", 4) && size == sizeof(LCDFramebuffer);
+  }
+
+  // Starts an in-place update; the frame may be written until endWrite().
+  void beginWrite() {
+    sequence.store(sequence.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+  void endWrite() {
+    sequence.store(sequence.load(std::memory_order_relaxed) + 1,
+                   std::memory_order_release);
+  }
+
+  // Copies a consistent frame; returns its (even) sequence number.
+  uint32_t read(LCDFrame *copy) const {
+    for (;;) {
+      uint32_t before = sequence.load(std::memory_order_acquire);
+      if (before & 1) {
+        std::this_thread::yield();
+        continue;
+      }
+      memcpy(copy, (const void *)&frame, sizeof(*copy));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence.load(std::memory_order_relaxed) == before) {
+        return before;
+      }
+    }
+  }
+};
@@ -0,0 +1,128 @@
+#pragma once
+#include "LiquidCrystal_CI.h"
+#include <string.h>
+
+// Shares the controller's eight custom character slots among any number of
+// glyphs. A glyph is uploaded with createChar() only when it isn't already
+// resident; identical bitmaps share a slot, and when all slots are taken the
+// least recently used one is reused. Slots shown on screen are never reused,
+// since rewriting one would change every cell that shows it.
+//
+//   LCDGlyphCache<16, 2> glyphs(lcd);
+//   glyphs.draw(0, 0, bellIcon);
+//   ...
+//   glyphs.release(0, 0); // before printing over the icon
+//
+// The cache only knows about cells it drew: call release() for a cell
+// before writing over it some other way, and clear() (or releaseAll() after
+// clearing the screen yourself) when the whole screen is redrawn.
+template <uint8_t COLS = 20, uint8_t ROWS = 4> class LCDGlyphCache {
+public:
+  static const uint8_t SLOTS = 8;
+
+  LCDGlyphCache(LiquidCrystal_CI &lcd)
+      : _lcd(lcd), _clock(0), _hits(0), _misses(0), _evictions(0) {
+    memset(_lastUse, 0, sizeof(_lastUse));
+    memset(_visible, 0, sizeof(_visible));
+    memset(_resident, 0, sizeof(_resident));
+    memset(_cells, 0, sizeof(_cells));
+  }
+
+  // Makes the glyph resident and returns its slot, or -1 if every slot is
+  // on screen. This is draw()'s building block: the slot isn't marked as
+  // shown, so the next load() or draw() may reuse it. To put a glyph on
+  // screen, use draw(), which keeps its slot until the cell is released.
+  int8_t load(const uint8_t bitmap[8]) {
+    ++_clock;
+    int8_t victim = -1;
+    for (uint8_t slot = 0; slot < SLOTS; ++slot) {
+      if (_resident[slot] && !memcmp(_bitmaps[slot], bitmap, 8)) {
+        ++_hits;
+        _lastUse[slot] = _clock;
+        return slot;
+      }
+      if (_visible[slot]) {
+        continue;
+      }
+      // empty slots first, then the least recently used
+      if (victim < 0 || (_resident[victim] && (!_resident[slot] ||
+                                               _lastUse[slot] <
+                                                   _lastUse[victim]))) {
+        victim = slot;
+      }
+    }
+    if (victim < 0) {
+      return -1;
+    }
+    ++_misses;
+    if (_resident[victim]) {
+      ++_evictions;
+    }
+    memcpy(_bitmaps[victim], bitmap, 8);
+    _resident[victim] = true;
+    _lastUse[victim] = _clock;
+    _lcd.createChar(victim, _bitmaps[victim]);
+    return victim;
+  }
+
+  // Shows the glyph at a cell. Returns false, without touching the display,
+  // if there's no slot free for it.
+  bool draw(uint8_t col, uint8_t row, const uint8_t bitmap[8]) {
+    if (col >= COLS || row >= ROWS) {
+      return false;
+    }
+    uint8_t &cell = _cells[row][col];
+    // the glyph this cell showed may be evicted to make room for the new one
+    if (cell) {
+      --_visible[cell - 1];
+    }
+    unsigned long misses = _misses;
+    int8_t slot = load(bitmap);
+    if (slot < 0) {
+      if (cell) {
+        ++_visible[cell - 1];
+      }
+      return false;
+    }
+    ++_visible[slot];
+    if (cell != slot + 1 || _misses != misses) {
+      _lcd.setCursor(col, row);
+      _lcd.write((uint8_t)slot);
+    }
+    cell = slot + 1;
+    return true;
+  }
+
+  // The cell no longer shows a glyph from the cache.
+  void release(uint8_t col, uint8_t row) {
+    if (col < COLS && row < ROWS && _cells[row][col]) {
+      --_visible[_cells[row][col] - 1];
+      _cells[row][col] = 0;
+    }
+  }
+  void releaseAll() {
+    memset(_visible, 0, sizeof(_visible));
+    memset(_cells, 0, sizeof(_cells));
+  }
+  void clear() {
+    _lcd.clear();
+    releaseAll();
+  }
+
+  // number of cells showing a slot
+  uint8_t getVisible(uint8_t slot) const { return _visible[slot]; }
+  unsigned long getHits() const { return _hits; }
+  // each miss is one createChar() upload
+  unsigned long getMisses() const { return _misses; }
+  unsigned long getEvictions() const { return _evictions; }
+
+private:
+  LiquidCrystal_CI &_lcd;
+  uint8_t _bitmaps[SLOTS][8];
+  bool _resident[SLOTS];
+  unsigned long _lastUse[SLOTS];
+  uint8_t _visible[SLOTS];
+  // per cell, 0 or 1 + the slot it shows
+  uint8_t _cells[ROWS][COLS];
+  unsigned long _clock, _hits, _misses, _evictions;
+};
@@ -0,0 +1,170 @@
+#include "LCDLatencyTracer.h"
+#ifdef ARDUINO_CI_COMPILATION_MOCKS
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+
+LCDLatencyTracer::LCDLatencyTracer(LiquidCrystal_CI &lcd)
+    : _lcd(lcd), _waiting(NONE), _shown(false), _pattern(""), _start(0),
+      _missed(0) {
+  _lcd.addListener(this);
+}
+
+LCDLatencyTracer::~LCDLatencyTracer() { _lcd.removeListener(this); }
+
+void LCDLatencyTracer::mark(const char *text) {
+  cancel();
+  _text = text;
+  _waiting = TEXT;
+  _shown = isVisible(_lcd);
+  _start = micros();
+}
+
+void LCDLatencyTracer::mark(const ScreenPattern &pattern) {
+  cancel();
+  _pattern = pattern;
+  _waiting = PATTERN;
+  _shown = isVisible(_lcd);
+  _start = micros();
+}
+
+void LCDLatencyTracer::cancel() {
+  if (_waiting != NONE) {
+    ++_missed;
+    _waiting = NONE;
+  }
+}
+
+void LCDLatencyTracer::onUpdate(LiquidCrystal_CI &lcd) {
+  if (_waiting == NONE) {
+    return;
+  }
+  bool shown = isVisible(lcd);
+  if (shown && !_shown) {
+    _samples.push_back(micros() - _start);
+    _waiting = NONE;
+  }
+  _shown = shown;
+}
+
+bool LCDLatencyTracer::isVisible(LiquidCrystal_CI &lcd) const {
+  if (!lcd.isDisplay()) {
+    return false;
+  }
+  // DDRAM outside the window is off screen
+  std::vector<String> lines = lcd.getVisibleLines();
+  if (_waiting == PATTERN) {
+    if (!_pattern.isValid() || _pattern.getRows() > (int)lines.size()) {
+      return false;
+    }
+    for (int row = 0; row < _pattern.getRows(); ++row) {
+      if (!_pattern.matchesRow(row, (const uint8_t *)lines[row].c_str(),
+                               lines[row].length())) {
+        return false;
+      }
+    }
+    return true;
+  }
+  for (size_t row = 0; row < lines.size(); ++row) {
+    if (lines[row].indexOf(_text) >= 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+unsigned long LCDLatencyTracer::getLast() const {
+  return _samples.empty() ? 0 : _samples.back();
+}
+
+unsigned long LCDLatencyTracer::getMin() const {
+  return _samples.empty() ? 0
+                          : *std::min_element(_samples.begin(), _samples.end());
+}
+
+unsigned long LCDLatencyTracer::getMax() const {
+  return _samples.empty() ? 0
+                          : *std::max_element(_samples.begin(), _samples.end());
+}
+
+unsigned long LCDLatencyTracer::getMean() const {
+  if (_samples.empty()) {
+    return 0;
+  }
+  unsigned long long total = 0;
+  for (size_t i = 0; i < _samples.size(); ++i) {
+    total += _samples[i];
+  }
+  return (total + _samples.size() / 2) / _samples.size();
+}
+
+unsigned long LCDLatencyTracer::getPercentile(double percent) const {
+  if (_samples.empty()) {
+    return 0;
+  }
+  std::vector<unsigned long> sorted = _samples;
+  std::sort(sorted.begin(), sorted.end());
+  // nearest rank
+  double rank = ceil(percent / 100 * sorted.size());
+  size_t index = rank < 1 ? 0 : (size_t)rank - 1;
+  return sorted[std::min(index, sorted.size() - 1)];
+}
+
+unsigned long LCDLatencyTracer::bucketWidthFor(unsigned long width) const {
+  if (width) {
+    return width;
+  }
+  width = (getMax() - getMin() + 10) / 10;
+  return width ? width : 1;
+}
+
+std::vector<unsigned long>
+LCDLatencyTracer::getBuckets(unsigned long bucketWidth,
+                             unsigned long *first) const {
+  std::vector<unsigned long> buckets;
+  unsigned long width = bucketWidthFor(bucketWidth);
+  unsigned long start = getMin() / width * width;
+  if (first) {
+    *first = start;
+  }
+  if (_samples.empty()) {
+    return buckets;
+  }
+  buckets.resize((getMax() - start) / width + 1);
+  for (size_t i = 0; i < _samples.size(); ++i) {
+    ++buckets[(_samples[i] - start) / width];
+  }
+  return buckets;
+}
+
+String LCDLatencyTracer::getHistogram(unsigned long bucketWidth) const {
+  unsigned long width = bucketWidthFor(bucketWidth), start;
+  std::vector<unsigned long> buckets = getBuckets(width, &start);
+  unsigned long most = 0;
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    most = std::max(most, buckets[i]);
+  }
+  String text;
+  char line[48];
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    unsigned long low = start + i * width;
+    snprintf(line, sizeof(line), "%10lu-%-10lu us %6lu ", low,
+             low + width - 1, buckets[i]);
+    text += line;
+    // bars of up to 40 characters
+    unsigned long bar = (buckets[i] * 40 + most - 1) / most;
+    for (unsigned long j = 0; j < bar; ++j) {
+      text += '#';
+    }
+    text += '\n';
+  }
+  return text;
+}
+
+void LCDLatencyTracer::reset() {
+  _waiting = NONE;
+  _missed = 0;
+  _samples.clear();
+}
+
+#endif
@@ -0,0 +1,78 @@
+#pragma once
+#include "Arduino.h"
+#ifdef ARDUINO_CI_COMPILATION_MOCKS
+#include "LiquidCrystal_CI.h"
+#include <vector>
+
+// Measures, in simulated time, how long a sketch takes to show the response
+// to an input: mark() the event, say what to wait for, and let the sketch
+// run. The latency is taken at the first call after the mark that brings
+// the text or the pattern onto the display, once the controller has been
+// sent the last byte of it. Only what the display shows counts: the window
+// onto DDRAM that the display shift selects, and nothing while the display
+// is off. If it is already there at the mark, it has to go away and come
+// back.
+//
+//   LCDLatencyTracer tracer(lcd);
+//   for (int run = 0; run < 100; ++run) {
+//     state->digitalPin[BUTTON] = LOW;
+//     tracer.mark("Menu");
+//     while (tracer.isWaiting()) {
+//       loop();
+//     }
+//     state->digitalPin[BUTTON] = HIGH;
+//     ...
+//   }
+//   Serial.print(tracer.getHistogram());
+//
+// Time comes from micros(), which the mocks advance with every delay,
+// including the ones LiquidCrystal makes while sending.
+class LCDLatencyTracer : public LiquidCrystal_CI::Listener {
+public:
+  LCDLatencyTracer(LiquidCrystal_CI &lcd);
+  ~LCDLatencyTracer();
+
+  // Starts a measurement at micros(). A measurement still waiting is
+  // counted as missed.
+  void mark(const char *text);
+  void mark(const ScreenPattern &pattern);
+  // stops waiting, counting the measurement as missed
+  void cancel();
+  bool isWaiting() const { return _waiting != NONE; }
+
+  // in microseconds, in the order they were taken
+  const std::vector<unsigned long> &getSamples() const { return _samples; }
+  unsigned long getLast() const;
+  unsigned long getCount() const { return _samples.size(); }
+  unsigned long getMissed() const { return _missed; }
+  unsigned long getMin() const;
+  unsigned long getMax() const;
+  unsigned long getMean() const;
+  // the sample below which the given percentage (0 to 100) of samples fall
+  unsigned long getPercentile(double percent) const;
+  // samples per bucket of bucketWidth microseconds, from the bucket holding
+  // getMin() to the one holding getMax(); a width of 0 picks one that gives
+  // about 10 buckets
+  std::vector<unsigned long> getBuckets(unsigned long bucketWidth,
+                                        unsigned long *first = nullptr) const;
+  // the buckets as text, one line per bucket with a bar of '#'
+  String getHistogram(unsigned long bucketWidth = 0) const;
+  void reset();
+
+  virtual void onUpdate(LiquidCrystal_CI &lcd);
+
+private:
+  enum { NONE, TEXT, PATTERN };
+  LiquidCrystal_CI &_lcd;
+  uint8_t _waiting;
+  bool _shown; // visible at the last update
+  String _text;
+  ScreenPattern _pattern;
+  unsigned long _start, _missed;
+  std::vector<unsigned long> _samples;
+
+  bool isVisible(LiquidCrystal_CI &lcd) const;
+  unsigned long bucketWidthFor(unsigned long bucketWidth) const;
+};
+
+#endif
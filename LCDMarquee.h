@@ -0,0 +1,103 @@
+#pragma once
+#include "LiquidCrystal_CI.h"
+#include <string.h>
+
+// Scrolls text across a line with the controller's display shift instead
+// of reprinting it. Each DDRAM line holds 40 characters, of which only the
+// display's width is visible; the marquee writes the text ahead of the
+// window, off screen, and each step() is a single scrollDisplayLeft(). Only
+// when the window catches up with what has been written is the off-screen
+// part refilled, in one burst of 40 - cols characters.
+//
+//   LCDMarquee banner(lcd, 0, 16);
+//   banner.setText("Gate 7 closes at 10:45 - please proceed to the gate");
+//   every 300 ms: banner.step();
+//
+// The shift moves every line of the display, so the other line scrolls
+// with the banner: keep it blank, or write it at columnFor(col), which
+// changes as the window moves. clear() and home() reset the shift; call
+// restart() after either. The text is not copied and must stay valid. On
+// four-line displays lines 3 and 4 continue lines 1 and 2 in DDRAM and
+// would be overwritten, so use a one- or two-line display.
+class LCDMarquee {
+public:
+  static const uint8_t LINE = 40; // DDRAM characters per line
+
+  LCDMarquee(LiquidCrystal_CI &lcd, uint8_t row, uint8_t cols)
+      : _lcd(lcd), _row(row), _cols(cols < LINE ? cols : LINE), _text(""),
+        _length(0), _period(1), _position(0), _filled(0), _refills(0) {}
+
+  // Shows text from its start, followed by gap spaces before it repeats.
+  void setText(const char *text, uint8_t gap = 4) {
+    _text = text;
+    _length = strlen(text);
+    _period = _length + gap;
+    if (_period == 0) {
+      _period = 1;
+    }
+    restart();
+  }
+
+  // Unshifts the display and rewrites the whole DDRAM line.
+  void restart() {
+    _lcd.home();
+    _position = 0;
+    _filled = 0;
+    fill();
+  }
+
+  // moves the text one column to the left
+  void step() {
+    if (_filled < _position + 1 + _cols) {
+      fill();
+    }
+    _lcd.scrollDisplayLeft();
+    ++_position;
+    // with no columns off screen, the new one can only be written now
+    if (_filled < _position + _cols) {
+      fill();
+    }
+    // keep the counters small without changing either modulus
+    uint32_t cycle = (uint32_t)_period * LINE;
+    if (_position >= cycle) {
+      _position -= cycle;
+      _filled -= cycle;
+    }
+  }
+
+  // the DDRAM column shown at visible column col
+  uint8_t columnFor(uint8_t col) const { return (col + _position) % LINE; }
+  // the window's offset into the text, 0 to the text length plus the gap
+  uint16_t getOffset() const { return _position % _period; }
+  // bursts of writes after the first fill
+  unsigned long getRefills() const { return _refills; }
+
+private:
+  LiquidCrystal_CI &_lcd;
+  uint8_t _row, _cols;
+  const char *_text;
+  uint16_t _length, _period;
+  uint32_t _position, _filled;
+  unsigned long _refills;
+
+  // Writes the text from _filled up to the window's left edge plus a line,
+  // as far ahead as DDRAM allows without overwriting a visible column.
+  void fill() {
+    uint32_t end = _position + LINE;
+    if (_filled >= end) {
+      return;
+    }
+    if (_filled) {
+      ++_refills;
+    }
+    while (_filled < end) {
+      // a new setCursor() where the address would run into the next line
+      uint8_t column = _filled % LINE;
+      _lcd.setCursor(column, _row);
+      for (; column < LINE && _filled < end; ++column, ++_filled) {
+        uint16_t index = _filled % _period;
+        _lcd.write(index < _length ? (uint8_t)_text[index] : (uint8_t)' ');
+      }
+    }
+  }
+};
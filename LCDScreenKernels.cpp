@@ -0,0 +1,213 @@
+#include "LCDScreenKernels.h"
+// host only: the mocks and extras/bench, not a sketch on a board
+#if !defined(ARDUINO) || defined(ARDUINO_CI_COMPILATION_MOCKS)
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LCD_KERNELS_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define LCD_KERNELS_NEON
+#endif
+
+const size_t LCDScreenKernels::NOT_FOUND;
+
+// The vector versions work on 16-byte blocks through two primitives that
+// return a bit mask with LANE_BITS bits per byte of the block: SSE2's
+// movemask gives one bit per byte, NEON's narrowing shift four.
+namespace {
+
+#if defined(LCD_KERNELS_SSE2)
+const int LANE_BITS = 1;
+const uint64_t FULL = 0xFFFF;
+
+inline uint64_t equalMask(const uint8_t *a, const uint8_t *b) {
+  __m128i x = _mm_loadu_si128((const __m128i *)a);
+  __m128i y = _mm_loadu_si128((const __m128i *)b);
+  return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(x, y));
+}
+
+// bytes of p equal to first where the byte length - 1 further on (q) is
+// equal to last
+inline uint64_t candidateMask(const uint8_t *p, const uint8_t *q,
+                              uint8_t first, uint8_t last) {
+  __m128i x = _mm_loadu_si128((const __m128i *)p);
+  __m128i y = _mm_loadu_si128((const __m128i *)q);
+  __m128i matches = _mm_and_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(first)),
+                                  _mm_cmpeq_epi8(y, _mm_set1_epi8(last)));
+  return (uint32_t)_mm_movemask_epi8(matches);
+}
+#elif defined(LCD_KERNELS_NEON)
+const int LANE_BITS = 4;
+const uint64_t FULL = ~(uint64_t)0;
+
+inline uint64_t toMask(uint8x16_t lanes) {
+  uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(lanes), 4);
+  return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+}
+
+inline uint64_t equalMask(const uint8_t *a, const uint8_t *b) {
+  return toMask(vceqq_u8(vld1q_u8(a), vld1q_u8(b)));
+}
+
+inline uint64_t candidateMask(const uint8_t *p, const uint8_t *q,
+                              uint8_t first, uint8_t last) {
+  uint8x16_t matches = vandq_u8(vceqq_u8(vld1q_u8(p), vdupq_n_u8(first)),
+                                vceqq_u8(vld1q_u8(q), vdupq_n_u8(last)));
+  return toMask(matches);
+}
+#endif
+
+#if defined(LCD_KERNELS_SSE2) || defined(LCD_KERNELS_NEON)
+const uint64_t LANE = (1 << LANE_BITS) - 1;
+
+inline int lowestLane(uint64_t mask) {
+  return __builtin_ctzll(mask) / LANE_BITS;
+}
+inline int countLanes(uint64_t mask) {
+  return __builtin_popcountll(mask) / LANE_BITS;
+}
+#endif
+
+} // namespace
+
+#if defined(LCD_KERNELS_SSE2) || defined(LCD_KERNELS_NEON)
+
+size_t LCDScreenKernels::find(const uint8_t *data, size_t size,
+                              const uint8_t *needle, size_t length) {
+  if (length == 0) {
+    return 0;
+  }
+  if (length > size) {
+    return NOT_FOUND;
+  }
+  uint8_t first = needle[0], last = needle[length - 1];
+  size_t i = 0;
+  for (; i + length - 1 + 16 <= size; i += 16) {
+    uint64_t mask = candidateMask(data + i, data + i + length - 1, first, last);
+    while (mask) {
+      int lane = lowestLane(mask);
+      if (length <= 2 ||
+          !memcmp(data + i + lane + 1, needle + 1, length - 2)) {
+        return i + lane;
+      }
+      mask &= ~(LANE << (lane * LANE_BITS));
+    }
+  }
+  size_t rest = findScalar(data + i, size - i, needle, length);
+  return rest == NOT_FOUND ? NOT_FOUND : i + rest;
+}
+
+bool LCDScreenKernels::equal(const uint8_t *a, const uint8_t *b,
+                             size_t size) {
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    if (equalMask(a + i, b + i) != FULL) {
+      return false;
+    }
+  }
+  return equalScalar(a + i, b + i, size - i);
+}
+
+size_t LCDScreenKernels::countDiff(const uint8_t *a, const uint8_t *b,
+                                   size_t size) {
+  size_t count = 0, i = 0;
+  for (; i + 16 <= size; i += 16) {
+    count += countLanes(~equalMask(a + i, b + i) & FULL);
+  }
+  return count + countDiffScalar(a + i, b + i, size - i);
+}
+
+size_t LCDScreenKernels::firstDiff(const uint8_t *a, const uint8_t *b,
+                                   size_t size) {
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    uint64_t diff = ~equalMask(a + i, b + i) & FULL;
+    if (diff) {
+      return i + lowestLane(diff);
+    }
+  }
+  return i + firstDiffScalar(a + i, b + i, size - i);
+}
+
+const char *LCDScreenKernels::implementation() {
+#if defined(LCD_KERNELS_SSE2)
+  return "SSE2";
+#else
+  return "NEON";
+#endif
+}
+
+#else
+
+size_t LCDScreenKernels::find(const uint8_t *data, size_t size,
+                              const uint8_t *needle, size_t length) {
+  return findScalar(data, size, needle, length);
+}
+
+bool LCDScreenKernels::equal(const uint8_t *a, const uint8_t *b,
+                             size_t size) {
+  return equalScalar(a, b, size);
+}
+
+size_t LCDScreenKernels::countDiff(const uint8_t *a, const uint8_t *b,
+                                   size_t size) {
+  return countDiffScalar(a, b, size);
+}
+
+size_t LCDScreenKernels::firstDiff(const uint8_t *a, const uint8_t *b,
+                                   size_t size) {
+  return firstDiffScalar(a, b, size);
+}
+
+const char *LCDScreenKernels::implementation() { return "scalar"; }
+
+#endif
+
+size_t LCDScreenKernels::findScalar(const uint8_t *data, size_t size,
+                                    const uint8_t *needle, size_t length) {
+  if (length > size) {
+    return NOT_FOUND;
+  }
+  for (size_t i = 0; i + length <= size; ++i) {
+    size_t j = 0;
+    while (j < length && data[i + j] == needle[j]) {
+      ++j;
+    }
+    if (j == length) {
+      return i;
+    }
+  }
+  return NOT_FOUND;
+}
+
+bool LCDScreenKernels::equalScalar(const uint8_t *a, const uint8_t *b,
+                                   size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    if (a[i] != b[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t LCDScreenKernels::countDiffScalar(const uint8_t *a, const uint8_t *b,
+                                         size_t size) {
+  size_t count = 0;
+  for (size_t i = 0; i < size; ++i) {
+    count += a[i] != b[i];
+  }
+  return count;
+}
+
+size_t LCDScreenKernels::firstDiffScalar(const uint8_t *a, const uint8_t *b,
+                                         size_t size) {
+  size_t i = 0;
+  while (i < size && a[i] == b[i]) {
+    ++i;
+  }
+  return i;
+}
+
+#endif
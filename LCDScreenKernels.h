@@ -0,0 +1,32 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Bulk operations over screen text held contiguously, such as LCDFleet's
+// grid or a batch of recorded frames. They use SSE2 on x86 and NEON on ARM
+// when the compiler targets them, and plain loops otherwise; the scalar
+// versions are always available for checking the vector ones.
+class LCDScreenKernels {
+public:
+  static const size_t NOT_FOUND = (size_t)-1;
+
+  // offset of the first occurrence of needle in data, or NOT_FOUND
+  static size_t find(const uint8_t *data, size_t size, const uint8_t *needle,
+                     size_t length);
+  static bool equal(const uint8_t *a, const uint8_t *b, size_t size);
+  // number of positions at which a and b differ
+  static size_t countDiff(const uint8_t *a, const uint8_t *b, size_t size);
+  // first position at which a and b differ, or size if they are equal
+  static size_t firstDiff(const uint8_t *a, const uint8_t *b, size_t size);
+
+  static size_t findScalar(const uint8_t *data, size_t size,
+                           const uint8_t *needle, size_t length);
+  static bool equalScalar(const uint8_t *a, const uint8_t *b, size_t size);
+  static size_t countDiffScalar(const uint8_t *a, const uint8_t *b,
+                                size_t size);
+  static size_t firstDiffScalar(const uint8_t *a, const uint8_t *b,
+                                size_t size);
+
+  // "SSE2", "NEON" or "scalar"
+  static const char *implementation();
+};
@@ -0,0 +1,128 @@
+#include "LCDTraceWriter.h"
+#ifdef ARDUINO_CI_COMPILATION_MOCKS
+#include <string.h>
+
+const size_t LCDTraceWriter::BUFFER_SIZE;
+
+bool LCDTraceWriter::open(const char *path) {
+  close();
+  _file = fopen(path, "w");
+  if (!_file) {
+    return false;
+  }
+  _buffer = new char[BUFFER_SIZE];
+  _used = 0;
+  _events = 0;
+  _bytes = 0;
+  append("{\"traceEvents\":[");
+  return true;
+}
+
+void LCDTraceWriter::close() {
+  if (!_file) {
+    return;
+  }
+  append("\n]}\n");
+  flush();
+  fclose(_file);
+  _file = nullptr;
+  delete[] _buffer;
+  _buffer = nullptr;
+}
+
+void LCDTraceWriter::complete(const char *name, const char *category,
+                              unsigned long start, unsigned long duration,
+                              uint32_t track, const char *args) {
+  if (!_file) {
+    return;
+  }
+  beginEvent();
+  append("{\"ph\":\"X\",\"name\":");
+  appendString(name);
+  append(",\"cat\":");
+  appendString(category);
+  append(",\"ts\":");
+  appendNumber(start);
+  append(",\"dur\":");
+  appendNumber(duration);
+  append(",\"pid\":1,\"tid\":");
+  appendNumber(track);
+  if (args) {
+    append(",\"args\":");
+    append(args);
+  }
+  append("}");
+}
+
+void LCDTraceWriter::nameTrack(uint32_t track, const char *name) {
+  if (!_file) {
+    return;
+  }
+  beginEvent();
+  append("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":");
+  appendNumber(track);
+  append(",\"args\":{\"name\":");
+  appendString(name);
+  append("}}");
+}
+
+void LCDTraceWriter::flush() {
+  if (_file && _used) {
+    fwrite(_buffer, 1, _used, _file);
+    fflush(_file);
+    _used = 0;
+  }
+}
+
+void LCDTraceWriter::beginEvent() {
+  append(_events++ ? ",\n" : "\n");
+}
+
+void LCDTraceWriter::append(const char *text, size_t length) {
+  _bytes += length;
+  while (length) {
+    if (_used == BUFFER_SIZE) {
+      flush();
+    }
+    size_t chunk = BUFFER_SIZE - _used;
+    if (chunk > length) {
+      chunk = length;
+    }
+    memcpy(_buffer + _used, text, chunk);
+    _used += chunk;
+    text += chunk;
+    length -= chunk;
+  }
+}
+
+void LCDTraceWriter::append(const char *text) { append(text, strlen(text)); }
+
+void LCDTraceWriter::appendString(const char *text) {
+  static const char hex[] = "0123456789abcdef";
+  append("\"", 1);
+  for (; *text; ++text) {
+    unsigned char c = *text;
+    if (c == '"' || c == '\\') {
+      char escaped[2] = {'\\', (char)c};
+      append(escaped, 2);
+    } else if (c < 0x20) {
+      char escaped[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 15]};
+      append(escaped, 6);
+    } else {
+      append((const char *)&c, 1);
+    }
+  }
+  append("\"", 1);
+}
+
+void LCDTraceWriter::appendNumber(unsigned long long value) {
+  char digits[20];
+  int i = sizeof(digits);
+  do {
+    digits[--i] = '0' + value % 10;
+    value /= 10;
+  } while (value);
+  append(digits + i, sizeof(digits) - i);
+}
+
+#endif
@@ -0,0 +1,86 @@
+#pragma once
+#include "Arduino.h"
+#ifdef ARDUINO_CI_COMPILATION_MOCKS
+#include <stdint.h>
+#include <stdio.h>
+
+// Writes a timeline in the Chrome trace event format, which opens in
+// ui.perfetto.dev and chrome://tracing. Events are formatted into a fixed
+// buffer that goes to the file whenever it fills, so a trace of hours of
+// simulated time needs no more memory than a short one. Times are in
+// microseconds of micros(), the mocks' virtual clock, which is what
+// LiquidCrystal_CI stamps its spans with (see traceTo()); spans of your own
+// on other tracks then line up with the display's.
+//
+//   LCDTraceWriter trace;
+//   trace.open("lcd.json");
+//   lcd.traceTo(&trace);
+//   for (int i = 0; i < 1000; ++i) {
+//     LCDTraceWriter::Span span(trace, "loop");
+//     loop();
+//   }
+//   trace.close();
+class LCDTraceWriter {
+public:
+  static const size_t BUFFER_SIZE = 64 * 1024;
+
+  LCDTraceWriter()
+      : _file(nullptr), _buffer(nullptr), _used(0), _events(0), _bytes(0) {}
+  ~LCDTraceWriter() { close(); }
+  // owns the buffer and the file
+  LCDTraceWriter(const LCDTraceWriter &) = delete;
+  LCDTraceWriter &operator=(const LCDTraceWriter &) = delete;
+
+  // false if the file can't be created
+  bool open(const char *path);
+  // writes the end of the trace; the file isn't valid JSON before this
+  void close();
+  bool isOpen() const { return _file != nullptr; }
+
+  // A span of duration microseconds from start on a track (a thread, in the
+  // viewer). args, if given, is a JSON object shown with the span.
+  void complete(const char *name, const char *category, unsigned long start,
+                unsigned long duration, uint32_t track = 0,
+                const char *args = nullptr);
+  // the name the viewer shows for a track
+  void nameTrack(uint32_t track, const char *name);
+  // sends buffered events to the file
+  void flush();
+
+  unsigned long getEvents() const { return _events; }
+  // bytes of trace so far, buffered or written
+  unsigned long long getBytes() const { return _bytes; }
+
+  // a span from construction to destruction
+  class Span {
+  public:
+    Span(LCDTraceWriter &writer, const char *name, uint32_t track = 0,
+         const char *category = "sketch")
+        : _writer(writer), _name(name), _category(category), _track(track),
+          _start(micros()) {}
+    ~Span() {
+      _writer.complete(_name, _category, _start, micros() - _start, _track);
+    }
+
+  private:
+    LCDTraceWriter &_writer;
+    const char *_name, *_category;
+    uint32_t _track;
+    unsigned long _start;
+  };
+
+private:
+  FILE *_file;
+  char *_buffer;
+  size_t _used;
+  unsigned long _events;
+  unsigned long long _bytes;
+
+  void beginEvent();
+  void append(const char *text, size_t length);
+  void append(const char *text);
+  void appendString(const char *text);
+  void appendNumber(unsigned long long value);
+};
+
+#endif
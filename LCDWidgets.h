@@ -0,0 +1,168 @@
+#pragma once
+#include "LiquidCrystal_CI.h"
+#include <string.h>
+
+// Widgets for values that are redrawn many times a second. Each remembers
+// what it last put on the display and sends only the cells that changed,
+// so a steady value costs nothing and a small change costs a few bytes
+// instead of the whole field. Nothing else may write over a widget's
+// cells; call invalidate() after clearing the screen so the next update
+// redraws it completely.
+
+// A right-aligned, fixed-width number, with an optional fixed decimal
+// point: with two decimals, set(-1234) shows "-12.34". Values too wide for
+// the field show as all '*'.
+class LCDNumberField {
+public:
+  static const uint8_t MAX_WIDTH = 20;
+
+  LCDNumberField(LiquidCrystal_CI &lcd, uint8_t col, uint8_t row,
+                 uint8_t width, uint8_t decimals = 0)
+      : _lcd(lcd), _col(col), _row(row),
+        _width(width < MAX_WIDTH ? width : MAX_WIDTH), _decimals(decimals),
+        _valid(false) {}
+
+  void set(long value) {
+    char text[MAX_WIDTH];
+    format(value, text);
+    uint8_t col = 0;
+    while (col < _width) {
+      if (_valid && text[col] == _shown[col]) {
+        ++col;
+        continue;
+      }
+      // a run of changed cells, taking in single unchanged cells between
+      // changes, which cost no more to rewrite than a second setCursor()
+      uint8_t end = col + 1;
+      while (end < _width) {
+        if (!_valid || text[end] != _shown[end]) {
+          ++end;
+        } else if (end + 1 < _width && text[end + 1] != _shown[end + 1]) {
+          end += 2;
+        } else {
+          break;
+        }
+      }
+      _lcd.setCursor(_col + col, _row);
+      _lcd.write(text + col, end - col);
+      col = end;
+    }
+    memcpy(_shown, text, _width);
+    _valid = true;
+  }
+
+  void invalidate() { _valid = false; }
+
+private:
+  LiquidCrystal_CI &_lcd;
+  uint8_t _col, _row, _width, _decimals;
+  bool _valid;
+  char _shown[MAX_WIDTH];
+
+  void format(long value, char *text) const {
+    bool negative = value < 0;
+    unsigned long magnitude =
+        negative ? 0UL - (unsigned long)value : (unsigned long)value;
+    int8_t i = _width - 1;
+    uint8_t digits = 0;
+    // digits right to left, at least one before the decimal point
+    while (i >= 0 && (magnitude || digits <= _decimals)) {
+      if (_decimals && digits == _decimals) {
+        text[i--] = '.';
+        if (i < 0) {
+          break;
+        }
+      }
+      text[i--] = '0' + magnitude % 10;
+      magnitude /= 10;
+      ++digits;
+    }
+    if (negative && i >= 0) {
+      text[i--] = '-';
+    } else if (negative || magnitude || digits <= _decimals) {
+      memset(text, '*', _width);
+      return;
+    }
+    while (i >= 0) {
+      text[i--] = ' ';
+    }
+  }
+};
+
+// A horizontal bar with five steps per cell, drawn with four partial-block
+// custom characters and the ROM's full block. A change of level rewrites
+// only the cells between the old and the new end of the bar, usually one.
+class LCDBarGraph {
+public:
+  enum { FULL_BLOCK = 0xFF };
+
+  // uses custom character slots firstSlot to firstSlot + 3
+  LCDBarGraph(LiquidCrystal_CI &lcd, uint8_t col, uint8_t row, uint8_t width,
+              uint8_t firstSlot = 0)
+      : _lcd(lcd), _col(col), _row(row), _width(width), _firstSlot(firstSlot),
+        _level(0), _valid(false) {}
+
+  // Uploads the partial blocks; call it after lcd.begin().
+  void begin() {
+    for (uint8_t columns = 1; columns <= 4; ++columns) {
+      uint8_t bitmap[8];
+      memset(bitmap, (0x1F << (5 - columns)) & 0x1F, sizeof(bitmap));
+      _lcd.createChar(_firstSlot + columns - 1, bitmap);
+    }
+    _valid = false;
+  }
+
+  uint16_t getMaximum() const { return _width * 5; }
+
+  // level is in 0..getMaximum(); larger values fill the bar
+  void set(uint16_t level) {
+    if (level > getMaximum()) {
+      level = getMaximum();
+    }
+    uint8_t first = 0, last = _width;
+    if (_valid) {
+      if (level == _level) {
+        return;
+      }
+      uint16_t low = level < _level ? level : _level;
+      uint16_t high = level < _level ? _level : level;
+      first = low / 5;
+      last = (high + 4) / 5;
+    }
+    _lcd.setCursor(_col + first, _row);
+    for (uint8_t cell = first; cell < last; ++cell) {
+      _lcd.write(glyph(level, cell));
+    }
+    _level = level;
+    _valid = true;
+  }
+  // value scaled from 0..maximum
+  void set(long value, long maximum) {
+    if (value <= 0 || maximum <= 0) {
+      set((uint16_t)0);
+    } else if (value >= maximum) {
+      set(getMaximum());
+    } else {
+      set((uint16_t)((value * getMaximum() + maximum / 2) / maximum));
+    }
+  }
+
+  void invalidate() { _valid = false; }
+
+private:
+  LiquidCrystal_CI &_lcd;
+  uint8_t _col, _row, _width, _firstSlot;
+  uint16_t _level;
+  bool _valid;
+
+  uint8_t glyph(uint16_t level, uint8_t cell) const {
+    int filled = (int)level - 5 * cell;
+    if (filled >= 5) {
+      return FULL_BLOCK;
+    }
+    if (filled <= 0) {
+      return ' ';
+    }
+    return _firstSlot + filled - 1;
+  }
+};
@@ -0,0 +1,214 @@
+#pragma once
+#include "LiquidCrystal_CI.h"
+
+// Front end that keeps a model of the controller state it has set (the
+// DDRAM address, display/cursor/blink, entry mode, display shift) and drops
+// calls that wouldn't change it: setCursor() to where the cursor already
+// is, display() on a display that is on, and so on. setCursor() is held
+// back until the next write, so several moves in a row cost one instruction,
+// except while the cursor is visible, when it is sent straight away.
+//
+//   LCDWriteCombiner screen(lcd);
+//   screen.begin(16, 2);
+//   screen.setCursor(0, 0); // elided: begin() left the cursor there
+//   screen.print(value);
+//
+// State starts out unknown, so nothing is dropped until begin() or the
+// first call that sets it. Go through the combiner for all calls, or call
+// forget() after using the display directly.
+class LCDWriteCombiner : public Print {
+public:
+  LCDWriteCombiner(LiquidCrystal_CI &lcd)
+      : _lcd(lcd), _rows(0), _cols(0), _elided(0), _forwarded(0) {
+    forget();
+  }
+
+  void begin(uint8_t cols, uint8_t rows, uint8_t charsize = LCD_5x8DOTS) {
+    _lcd.begin(cols, rows, charsize);
+    ++_forwarded;
+    _cols = cols;
+    _rows = rows;
+    // what LiquidCrystal::begin() leaves behind
+    _address = 0;
+    _pending = NONE;
+    _display = 1;
+    _cursor = 0;
+    _blink = 0;
+    _leftToRight = 1;
+    _autoscroll = 0;
+    _shifted = 0;
+  }
+
+  void clear() {
+    dropPending();
+    _lcd.clear();
+    ++_forwarded;
+    _address = 0;
+    _shifted = 0;
+    // clear sets the controller to left-to-right, but LiquidCrystal's next
+    // entry mode instruction restores what it last sent
+    if (_leftToRight != 1) {
+      _leftToRight = UNKNOWN;
+    }
+  }
+  void home() {
+    dropPending();
+    if (_address == 0 && _shifted == 0) {
+      ++_elided;
+      return;
+    }
+    _lcd.home();
+    ++_forwarded;
+    _address = 0;
+    _shifted = 0;
+  }
+  void setCursor(uint8_t col, uint8_t row) {
+    dropPending();
+    if (_rows == 0) {
+      // geometry unknown until begin()
+      _lcd.setCursor(col, row);
+      ++_forwarded;
+      _address = UNKNOWN;
+      return;
+    }
+    int16_t address = addressOf(col, row);
+    if (address == _address) {
+      ++_elided;
+      return;
+    }
+    _pending = address;
+    _pendingCol = col;
+    _pendingRow = row;
+    if (_cursor != 0 || _blink != 0) {
+      flush();
+    }
+  }
+
+  void display() { setFlag(_display, 1, &LiquidCrystal_CI::display); }
+  void noDisplay() { setFlag(_display, 0, &LiquidCrystal_CI::noDisplay); }
+  void cursor() {
+    setFlag(_cursor, 1, &LiquidCrystal_CI::cursor);
+    flush();
+  }
+  void noCursor() { setFlag(_cursor, 0, &LiquidCrystal_CI::noCursor); }
+  void blink() {
+    setFlag(_blink, 1, &LiquidCrystal_CI::blink);
+    flush();
+  }
+  void noBlink() { setFlag(_blink, 0, &LiquidCrystal_CI::noBlink); }
+  void leftToRight() {
+    setFlag(_leftToRight, 1, &LiquidCrystal_CI::leftToRight);
+  }
+  void rightToLeft() {
+    setFlag(_leftToRight, 0, &LiquidCrystal_CI::rightToLeft);
+  }
+  void autoscroll() { setFlag(_autoscroll, 1, &LiquidCrystal_CI::autoscroll); }
+  void noAutoscroll() {
+    setFlag(_autoscroll, 0, &LiquidCrystal_CI::noAutoscroll);
+  }
+  void scrollDisplayLeft() {
+    _lcd.scrollDisplayLeft();
+    ++_forwarded;
+    _shifted = UNKNOWN;
+  }
+  void scrollDisplayRight() {
+    _lcd.scrollDisplayRight();
+    ++_forwarded;
+    _shifted = UNKNOWN;
+  }
+  void createChar(uint8_t location, uint8_t charmap[]) {
+    _lcd.createChar(location, charmap);
+    ++_forwarded;
+    // the address now points into CGRAM
+    _address = UNKNOWN;
+  }
+
+  virtual size_t write(uint8_t value) {
+    flush();
+    size_t written = _lcd.write(value);
+    ++_forwarded;
+    advance();
+    return written;
+  }
+  using Print::write;
+
+  // sends a held-back setCursor()
+  void flush() {
+    if (_pending != NONE) {
+      _lcd.setCursor(_pendingCol, _pendingRow);
+      ++_forwarded;
+      _address = _pending;
+      _pending = NONE;
+    }
+  }
+  // assume nothing about the controller state from here on
+  void forget() {
+    _address = UNKNOWN;
+    _pending = NONE;
+    _display = _cursor = _blink = UNKNOWN;
+    _leftToRight = _autoscroll = _shifted = UNKNOWN;
+  }
+
+  // calls dropped, and calls passed on to the display
+  unsigned long getElided() const { return _elided; }
+  unsigned long getForwarded() const { return _forwarded; }
+
+private:
+  static const int8_t UNKNOWN = -1;
+  static const int16_t NONE = -1;
+  LiquidCrystal_CI &_lcd;
+  uint8_t _rows, _cols;
+  int16_t _address, _pending;
+  uint8_t _pendingCol, _pendingRow;
+  int8_t _display, _cursor, _blink, _leftToRight, _autoscroll, _shifted;
+  unsigned long _elided, _forwarded;
+
+  // DDRAM address for a position, clamped as LiquidCrystal does
+  int16_t addressOf(uint8_t col, uint8_t row) const {
+    if (row >= 4) {
+      row = 3;
+    }
+    if (row >= _rows) {
+      row = _rows - 1;
+    }
+    static const uint8_t lineStart[4] = {0x00, 0x40, 0x00, 0x40};
+    return lineStart[row] + (row >= 2 ? _cols : 0) + col;
+  }
+
+  void dropPending() {
+    if (_pending != NONE) {
+      ++_elided;
+      _pending = NONE;
+    }
+  }
+
+  void setFlag(int8_t &flag, int8_t value, void (LiquidCrystal_CI::*call)()) {
+    if (flag == value) {
+      ++_elided;
+      return;
+    }
+    (_lcd.*call)();
+    ++_forwarded;
+    flag = value;
+  }
+
+  // the controller's address counter after a data write
+  void advance() {
+    if (_address == UNKNOWN || _leftToRight == UNKNOWN ||
+        _autoscroll == UNKNOWN) {
+      _address = UNKNOWN;
+      return;
+    }
+    if (_autoscroll) {
+      _shifted = UNKNOWN;
+    }
+    if (_rows == 1) {
+      // one line of 80 characters
+      _address = _leftToRight ? (_address + 1) % 80 : (_address + 79) % 80;
+    } else if (_leftToRight) {
+      _address = _address == 0x27 ? 0x40 : _address == 0x67 ? 0 : _address + 1;
+    } else {
+      _address = _address == 0x40 ? 0x27 : _address == 0 ? 0x67 : _address - 1;
+    }
+  }
+};
@@ -0,0 +1,417 @@
+#include "LiquidCrystalFast.h"
+
+LiquidCrystalFast::LiquidCrystalFast(uint8_t rs, uint8_t rw, uint8_t enable,
+                                     uint8_t d0, uint8_t d1, uint8_t d2,
+                                     uint8_t d3, uint8_t d4, uint8_t d5,
+                                     uint8_t d6, uint8_t d7) {
+  init(0, rs, rw, enable, d0, d1, d2, d3, d4, d5, d6, d7);
+}
+
+LiquidCrystalFast::LiquidCrystalFast(uint8_t rs, uint8_t enable, uint8_t d0,
+                                     uint8_t d1, uint8_t d2, uint8_t d3,
+                                     uint8_t d4, uint8_t d5, uint8_t d6,
+                                     uint8_t d7) {
+  init(0, rs, 255, enable, d0, d1, d2, d3, d4, d5, d6, d7);
+}
+
+LiquidCrystalFast::LiquidCrystalFast(uint8_t rs, uint8_t rw, uint8_t enable,
+                                     uint8_t d0, uint8_t d1, uint8_t d2,
+                                     uint8_t d3) {
+  init(1, rs, rw, enable, d0, d1, d2, d3, 0, 0, 0, 0);
+}
+
+LiquidCrystalFast::LiquidCrystalFast(uint8_t rs, uint8_t enable, uint8_t d0,
+                                     uint8_t d1, uint8_t d2, uint8_t d3) {
+  init(1, rs, 255, enable, d0, d1, d2, d3, 0, 0, 0, 0);
+}
+
+void LiquidCrystalFast::init(uint8_t fourbitmode, uint8_t rs, uint8_t rw,
+                             uint8_t enable, uint8_t d0, uint8_t d1,
+                             uint8_t d2, uint8_t d3, uint8_t d4, uint8_t d5,
+                             uint8_t d6, uint8_t d7) {
+  _rs_pin = rs;
+  _rw_pin = rw;
+  _enable_pin = enable;
+
+  _data_pins[0] = d0;
+  _data_pins[1] = d1;
+  _data_pins[2] = d2;
+  _data_pins[3] = d3;
+  _data_pins[4] = d4;
+  _data_pins[5] = d5;
+  _data_pins[6] = d6;
+  _data_pins[7] = d7;
+
+  if (fourbitmode) {
+    _displayfunction = LCD_4BITMODE | LCD_1LINE | LCD_5x8DOTS;
+  } else {
+    _displayfunction = LCD_8BITMODE | LCD_1LINE | LCD_5x8DOTS;
+  }
+  _timing = LCD_TIMING_HD44780_SLOW;
+
+  begin(16, 1);
+}
+
+void LiquidCrystalFast::begin(uint8_t cols, uint8_t lines, uint8_t dotsize) {
+  if (lines > 1) {
+    _displayfunction |= LCD_2LINE;
+  }
+  _numlines = lines;
+
+  setRowOffsets(0x00, 0x40, 0x00 + cols, 0x40 + cols);
+
+  // for some 1 line displays you can select a 10 pixel high font
+  if ((dotsize != LCD_5x8DOTS) && (lines == 1)) {
+    _displayfunction |= LCD_5x10DOTS;
+  }
+
+  pinMode(_rs_pin, OUTPUT);
+  if (_rw_pin != 255) {
+    pinMode(_rw_pin, OUTPUT);
+  }
+  pinMode(_enable_pin, OUTPUT);
+  for (int i = 0; i < ((_displayfunction & LCD_8BITMODE) ? 8 : 4); ++i) {
+    pinMode(_data_pins[i], OUTPUT);
+  }
+
+  // The power-on sequence is fixed by the datasheet, not by the profile:
+  // at least 40 ms after Vcc rises, then 4.1 ms, 100 us between the
+  // three function sets that force the interface into a known mode.
+  delayMicroseconds(50000);
+  digitalWrite(_rs_pin, LOW);
+  digitalWrite(_enable_pin, LOW);
+  if (_rw_pin != 255) {
+    digitalWrite(_rw_pin, LOW);
+  }
+
+  if (!(_displayfunction & LCD_8BITMODE)) {
+    write4bits(0x03);
+    delayMicroseconds(4500);
+    write4bits(0x03);
+    delayMicroseconds(4500);
+    write4bits(0x03);
+    delayMicroseconds(150);
+    write4bits(0x02);
+    delayMicroseconds(_timing.command);
+  } else {
+    command(LCD_FUNCTIONSET | _displayfunction);
+    delayMicroseconds(4500);
+    command(LCD_FUNCTIONSET | _displayfunction);
+    delayMicroseconds(150);
+    command(LCD_FUNCTIONSET | _displayfunction);
+  }
+
+  command(LCD_FUNCTIONSET | _displayfunction);
+
+  _displaycontrol = LCD_DISPLAYON | LCD_CURSOROFF | LCD_BLINKOFF;
+  display();
+
+  clear();
+
+  _displaymode = LCD_ENTRYLEFT | LCD_ENTRYSHIFTDECREMENT;
+  command(LCD_ENTRYMODESET | _displaymode);
+}
+
+void LiquidCrystalFast::setRowOffsets(int row0, int row1, int row2,
+                                      int row3) {
+  _row_offsets[0] = row0;
+  _row_offsets[1] = row1;
+  _row_offsets[2] = row2;
+  _row_offsets[3] = row3;
+}
+
+/********** high level commands, for the user! */
+void LiquidCrystalFast::clear() { command(LCD_CLEARDISPLAY); }
+
+void LiquidCrystalFast::home() { command(LCD_RETURNHOME); }
+
+void LiquidCrystalFast::setCursor(uint8_t col, uint8_t row) {
+  command(LCD_SETDDRAMADDR | cursorAddress(col, row));
+}
+
+// DDRAM address of a screen position, as used by setCursor()
+uint8_t LiquidCrystalFast::cursorAddress(uint8_t col, uint8_t row) const {
+  const size_t max_lines = sizeof(_row_offsets) / sizeof(*_row_offsets);
+  if (row >= max_lines) {
+    row = max_lines - 1;
+  }
+  if (row >= _numlines) {
+    row = _numlines - 1;
+  }
+  return col + _row_offsets[row];
+}
+
+// Turn the display on/off (quickly)
+void LiquidCrystalFast::noDisplay() {
+  _displaycontrol &= ~LCD_DISPLAYON;
+  command(LCD_DISPLAYCONTROL | _displaycontrol);
+}
+void LiquidCrystalFast::display() {
+  _displaycontrol |= LCD_DISPLAYON;
+  command(LCD_DISPLAYCONTROL | _displaycontrol);
+}
+
+// Turns the underline cursor on/off
+void LiquidCrystalFast::noCursor() {
+  _displaycontrol &= ~LCD_CURSORON;
+  command(LCD_DISPLAYCONTROL | _displaycontrol);
+}
+void LiquidCrystalFast::cursor() {
+  _displaycontrol |= LCD_CURSORON;
+  command(LCD_DISPLAYCONTROL | _displaycontrol);
+}
+
+// Turn on and off the blinking cursor
+void LiquidCrystalFast::noBlink() {
+  _displaycontrol &= ~LCD_BLINKON;
+  command(LCD_DISPLAYCONTROL | _displaycontrol);
+}
+void LiquidCrystalFast::blink() {
+  _displaycontrol |= LCD_BLINKON;
+  command(LCD_DISPLAYCONTROL | _displaycontrol);
+}
+
+// These commands scroll the display without changing the RAM
+void LiquidCrystalFast::scrollDisplayLeft() {
+  command(LCD_CURSORSHIFT | LCD_DISPLAYMOVE | LCD_MOVELEFT);
+}
+void LiquidCrystalFast::scrollDisplayRight() {
+  command(LCD_CURSORSHIFT | LCD_DISPLAYMOVE | LCD_MOVERIGHT);
+}
+
+// This is for text that flows Left to Right
+void LiquidCrystalFast::leftToRight() {
+  _displaymode |= LCD_ENTRYLEFT;
+  command(LCD_ENTRYMODESET | _displaymode);
+}
+
+// This is for text that flows Right to Left
+void LiquidCrystalFast::rightToLeft() {
+  _displaymode &= ~LCD_ENTRYLEFT;
+  command(LCD_ENTRYMODESET | _displaymode);
+}
+
+// This will 'right justify' text from the cursor
+void LiquidCrystalFast::autoscroll() {
+  _displaymode |= LCD_ENTRYSHIFTINCREMENT;
+  command(LCD_ENTRYMODESET | _displaymode);
+}
+
+// This will 'left justify' text from the cursor
+void LiquidCrystalFast::noAutoscroll() {
+  _displaymode &= ~LCD_ENTRYSHIFTINCREMENT;
+  command(LCD_ENTRYMODESET | _displaymode);
+}
+
+// Allows us to fill the first 8 CGRAM locations
+// with custom characters
+void LiquidCrystalFast::createChar(uint8_t location, uint8_t charmap[]) {
+  location &= 0x7; // we only have 8 locations 0-7
+  command(LCD_SETCGRAMADDR | (location << 3));
+  for (int i = 0; i < 8; i++) {
+    write(charmap[i]);
+  }
+}
+
+/*********** mid level commands, for sending data/cmds */
+
+void LiquidCrystalFast::command(uint8_t value) { send(value, LOW); }
+
+size_t LiquidCrystalFast::write(uint8_t value) {
+  send(value, HIGH);
+  return 1;
+}
+
+uint16_t LiquidCrystalFast::executionTime(uint8_t value, uint8_t mode) const {
+  if (mode != LOW) {
+    return _timing.data;
+  }
+  // clear display (0x01) and return home (0x02/0x03)
+  return value < LCD_ENTRYMODESET ? _timing.clearHome : _timing.command;
+}
+
+/************ low level data pushing commands **********/
+
+uint16_t LiquidCrystalFast::transfer(uint8_t value, uint8_t mode) {
+  digitalWrite(_rs_pin, mode);
+
+  // if there is a RW pin indicated, set it low to Write
+  if (_rw_pin != 255) {
+    digitalWrite(_rw_pin, LOW);
+  }
+
+  if (_displayfunction & LCD_8BITMODE) {
+    write8bits(value);
+  } else {
+    // the controller latches the high nibble immediately, so only the
+    // enable cycle time is needed before the low nibble
+    write4bits(value >> 4);
+    delayMicroseconds(_timing.enable);
+    write4bits(value);
+  }
+  return executionTime(value, mode);
+}
+
+void LiquidCrystalFast::send(uint8_t value, uint8_t mode) {
+  delayMicroseconds(transfer(value, mode));
+}
+
+void LiquidCrystalFast::pulseEnable() {
+  digitalWrite(_enable_pin, LOW);
+  digitalWrite(_enable_pin, HIGH);
+  delayMicroseconds(_timing.enable); // enable pulse must be >450ns
+  digitalWrite(_enable_pin, LOW);
+}
+
+void LiquidCrystalFast::write4bits(uint8_t value) {
+  for (int i = 0; i < 4; i++) {
+    digitalWrite(_data_pins[i], (value >> i) & 0x01);
+  }
+  pulseEnable();
+}
+
+void LiquidCrystalFast::write8bits(uint8_t value) {
+  for (int i = 0; i < 8; i++) {
+    digitalWrite(_data_pins[i], (value >> i) & 0x01);
+  }
+  pulseEnable();
+}
+
+#ifdef ARDUINO_CI_COMPILATION_MOCKS
+
+LiquidCrystalFast_CI::LiquidCrystalFast_CI(uint8_t rs, uint8_t rw,
+                                           uint8_t enable, uint8_t d0,
+                                           uint8_t d1, uint8_t d2, uint8_t d3,
+                                           uint8_t d4, uint8_t d5, uint8_t d6,
+                                           uint8_t d7)
+    : LiquidCrystalFast(rs, rw, enable, d0, d1, d2, d3, d4, d5, d6, d7) {
+  initShadow();
+}
+
+LiquidCrystalFast_CI::LiquidCrystalFast_CI(uint8_t rs, uint8_t enable,
+                                           uint8_t d0, uint8_t d1, uint8_t d2,
+                                           uint8_t d3, uint8_t d4, uint8_t d5,
+                                           uint8_t d6, uint8_t d7)
+    : LiquidCrystalFast(rs, enable, d0, d1, d2, d3, d4, d5, d6, d7) {
+  initShadow();
+}
+
+LiquidCrystalFast_CI::LiquidCrystalFast_CI(uint8_t rs, uint8_t rw,
+                                           uint8_t enable, uint8_t d0,
+                                           uint8_t d1, uint8_t d2, uint8_t d3)
+    : LiquidCrystalFast(rs, rw, enable, d0, d1, d2, d3) {
+  initShadow();
+}
+
+LiquidCrystalFast_CI::LiquidCrystalFast_CI(uint8_t rs, uint8_t enable,
+                                           uint8_t d0, uint8_t d1, uint8_t d2,
+                                           uint8_t d3)
+    : LiquidCrystalFast(rs, enable, d0, d1, d2, d3) {
+  initShadow();
+}
+
+// The base constructor's begin(16, 1) ran before our transfer() override
+// was in place, so start from the state that sequence leaves behind.
+void LiquidCrystalFast_CI::initShadow() {
+  _col = 0;
+  _cols = 16;
+  _row = 0;
+  _rows = 1;
+  _cgramAddress = 0;
+  _autoscroll = false;
+  _display = true;
+  _cursor = false;
+  _blink = false;
+  _inCgram = false;
+  _lines.clear();
+  _lines.resize(_rows);
+  for (int character = 0; character < 8; character++) {
+    for (int bite = 0; bite < 8; bite++) {
+      _customChars[character][bite] = B00000;
+    }
+  }
+  _instances[_rs_pin] = this;
+}
+
+void LiquidCrystalFast_CI::begin(uint8_t cols, uint8_t lines,
+                                 uint8_t dotsize) {
+  _cols = cols;
+  _rows = lines;
+  _lines.clear();
+  _lines.resize(_rows);
+  LiquidCrystalFast::begin(cols, lines, dotsize);
+}
+
+uint16_t LiquidCrystalFast_CI::transfer(uint8_t value, uint8_t mode) {
+  uint16_t wait = LiquidCrystalFast::transfer(value, mode);
+  if (mode == LOW) {
+    decodeCommand(value);
+  } else {
+    decodeData(value);
+  }
+  return wait;
+}
+
+void LiquidCrystalFast_CI::decodeCommand(uint8_t value) {
+  if (value & LCD_SETDDRAMADDR) {
+    // map the address back through the row offsets used by setCursor()
+    uint8_t address = value & 0x7F;
+    _inCgram = false;
+    _row = 0;
+    for (int row = 1; row < _rows && row < 4; ++row) {
+      if (_row_offsets[row] <= address &&
+          _row_offsets[row] >= _row_offsets[_row]) {
+        _row = row;
+      }
+    }
+    _col = address - _row_offsets[_row];
+  } else if (value & LCD_SETCGRAMADDR) {
+    _inCgram = true;
+    _cgramAddress = value & 0x3F;
+  } else if (value & (LCD_FUNCTIONSET | LCD_CURSORSHIFT)) {
+    // nothing in the shadow depends on these
+  } else if (value & LCD_DISPLAYCONTROL) {
+    _display = value & LCD_DISPLAYON;
+    _cursor = value & LCD_CURSORON;
+    _blink = value & LCD_BLINKON;
+  } else if (value & LCD_ENTRYMODESET) {
+    _autoscroll = value & LCD_ENTRYSHIFTINCREMENT;
+  } else if (value & LCD_RETURNHOME) {
+    _inCgram = false;
+    _col = _row = 0;
+  } else if (value & LCD_CLEARDISPLAY) {
+    _inCgram = false;
+    _col = _row = 0;
+    _lines.clear();
+    _lines.resize(_rows);
+  }
+}
+
+void LiquidCrystalFast_CI::decodeData(uint8_t value) {
+  if (_inCgram) {
+    _customChars[_cgramAddress >> 3][_cgramAddress & 7] = value;
+    _cgramAddress = (_cgramAddress + 1) & 0x3F;
+    return;
+  }
+  if (_row >= (int)_lines.size() || (_autoscroll && _col == 0)) {
+    return;
+  }
+  // same shadow rules as LiquidCrystal_CI::write()
+  String &line = _lines.at(_row);
+  int end = _autoscroll ? (_col - 1) : _col;
+  while ((int)line.length() <= end) {
+    line += ' ';
+  }
+  if (_autoscroll) {
+    for (int i = 0; i < (_col - 1); i++) {
+      line.at(i) = line.at(i + 1);
+    }
+    --_col;
+  }
+  line.at(_col) = value;
+  ++_col;
+}
+
+LiquidCrystalFast_CI *LiquidCrystalFast_CI::_instances[MOCK_PINS_COUNT];
+
+#endif
@@ -0,0 +1,149 @@
+#pragma once
+#include "Arduino.h"
+#include <LiquidCrystal.h>
+
+// Microseconds to wait after each kind of transfer. LiquidCrystal waits a
+// fixed 100 us after every enable pulse (so 200 us per byte in 4-bit mode)
+// and 2 ms after clear/home; the controller needs much less.
+struct LCDTiming {
+  uint16_t enable;    // enable pulse width and gap between the two nibbles
+  uint16_t command;   // any instruction other than clear/home
+  uint16_t data;      // write to DDRAM or CGRAM
+  uint16_t clearHome; // clear display and return home
+};
+
+// HD44780U execution times at the typical 270 kHz oscillator
+constexpr LCDTiming LCD_TIMING_HD44780 = {1, 37, 41, 1520};
+// the same at the slowest oscillator allowed by the datasheet (190 kHz)
+constexpr LCDTiming LCD_TIMING_HD44780_SLOW = {1, 53, 59, 2160};
+// LiquidCrystal's own delays, for panels that need them
+constexpr LCDTiming LCD_TIMING_CONSERVATIVE = {1, 100, 100, 2000};
+
+template <uint16_t SIZE> class LiquidCrystalQueue;
+
+// Drop-in replacement for LiquidCrystal that drives the same pins with the
+// same bit patterns but waits only as long as the timing profile says.
+class LiquidCrystalFast : public Print {
+public:
+  LiquidCrystalFast(uint8_t rs, uint8_t enable, uint8_t d0, uint8_t d1,
+                    uint8_t d2, uint8_t d3, uint8_t d4, uint8_t d5, uint8_t d6,
+                    uint8_t d7);
+  LiquidCrystalFast(uint8_t rs, uint8_t rw, uint8_t enable, uint8_t d0,
+                    uint8_t d1, uint8_t d2, uint8_t d3, uint8_t d4, uint8_t d5,
+                    uint8_t d6, uint8_t d7);
+  LiquidCrystalFast(uint8_t rs, uint8_t rw, uint8_t enable, uint8_t d0,
+                    uint8_t d1, uint8_t d2, uint8_t d3);
+  LiquidCrystalFast(uint8_t rs, uint8_t enable, uint8_t d0, uint8_t d1,
+                    uint8_t d2, uint8_t d3);
+  virtual ~LiquidCrystalFast() {}
+
+  void init(uint8_t fourbitmode, uint8_t rs, uint8_t rw, uint8_t enable,
+            uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3, uint8_t d4,
+            uint8_t d5, uint8_t d6, uint8_t d7);
+  void begin(uint8_t cols, uint8_t rows, uint8_t charsize = LCD_5x8DOTS);
+  void clear();
+  void home();
+  void noDisplay();
+  void display();
+  void noBlink();
+  void blink();
+  void noCursor();
+  void cursor();
+  void scrollDisplayLeft();
+  void scrollDisplayRight();
+  void leftToRight();
+  void rightToLeft();
+  void autoscroll();
+  void noAutoscroll();
+  void setRowOffsets(int row1, int row2, int row3, int row4);
+  void createChar(uint8_t, uint8_t[]);
+  void setCursor(uint8_t, uint8_t);
+  virtual size_t write(uint8_t);
+  void command(uint8_t);
+  using Print::write;
+
+  uint8_t cursorAddress(uint8_t col, uint8_t row) const;
+  void setTiming(const LCDTiming &timing) { _timing = timing; }
+  const LCDTiming &getTiming() const { return _timing; }
+  // Put one byte on the bus without waiting for the controller; returns the
+  // microseconds that must pass before the next transfer.
+  virtual uint16_t transfer(uint8_t value, uint8_t mode);
+  uint16_t executionTime(uint8_t value, uint8_t mode) const;
+
+protected:
+  // LiquidCrystalQueue keeps _displaycontrol in step with the toggles it
+  // queues
+  template <uint16_t SIZE> friend class LiquidCrystalQueue;
+
+  void send(uint8_t value, uint8_t mode);
+  void write4bits(uint8_t value);
+  void write8bits(uint8_t value);
+  void pulseEnable();
+
+  uint8_t _rs_pin;
+  uint8_t _rw_pin;
+  uint8_t _enable_pin;
+  uint8_t _data_pins[8];
+  uint8_t _displayfunction;
+  uint8_t _displaycontrol;
+  uint8_t _displaymode;
+  uint8_t _numlines;
+  uint8_t _row_offsets[4];
+  LCDTiming _timing;
+};
+
+#ifndef ARDUINO_CI_COMPILATION_MOCKS
+#define LiquidCrystalFast_CI LiquidCrystalFast
+#else
+#include <vector>
+
+// Mock with the same testing API as LiquidCrystal_CI. The shadow state is
+// decoded from the bytes sent to the controller, so anything that reaches
+// the bus (including raw command() and transfer() calls) is reflected.
+class LiquidCrystalFast_CI : public LiquidCrystalFast {
+public:
+  LiquidCrystalFast_CI(uint8_t rs, uint8_t enable, uint8_t d0, uint8_t d1,
+                       uint8_t d2, uint8_t d3, uint8_t d4, uint8_t d5,
+                       uint8_t d6, uint8_t d7);
+  LiquidCrystalFast_CI(uint8_t rs, uint8_t rw, uint8_t enable, uint8_t d0,
+                       uint8_t d1, uint8_t d2, uint8_t d3, uint8_t d4,
+                       uint8_t d5, uint8_t d6, uint8_t d7);
+  LiquidCrystalFast_CI(uint8_t rs, uint8_t rw, uint8_t enable, uint8_t d0,
+                       uint8_t d1, uint8_t d2, uint8_t d3);
+  LiquidCrystalFast_CI(uint8_t rs, uint8_t enable, uint8_t d0, uint8_t d1,
+                       uint8_t d2, uint8_t d3);
+  ~LiquidCrystalFast_CI() {
+    if (_instances[_rs_pin] == this) {
+      _instances[_rs_pin] = nullptr;
+    }
+  }
+  void begin(uint8_t cols, uint8_t rows, uint8_t charsize = LCD_5x8DOTS);
+  uint16_t transfer(uint8_t value, uint8_t mode);
+  virtual String className() const { return "LiquidCrystalFast_CI"; }
+
+  // testing methods
+  static LiquidCrystalFast_CI *forRsPin(uint8_t rs) { return _instances[rs]; }
+  std::vector<String> getLines() { return _lines; }
+  int getRows() { return _rows; }
+  bool isAutoscroll() { return _autoscroll; }
+  bool isBlink() { return _blink; }
+  bool isCursor() { return _cursor; }
+  bool isDisplay() { return _display; }
+  byte *getCustomCharacter(uint8_t customChar) {
+    return _customChars[customChar];
+  }
+  int getCursorCol() { return _col; }
+  int getCursorRow() { return _row; }
+
+private:
+  static LiquidCrystalFast_CI *_instances[MOCK_PINS_COUNT];
+  int _col, _cols, _row, _rows, _cgramAddress;
+  bool _display, _cursor, _blink, _autoscroll, _inCgram;
+  std::vector<String> _lines;
+  byte _customChars[8][8];
+  void initShadow();
+  void decodeCommand(uint8_t value);
+  void decodeData(uint8_t value);
+};
+
+#endif
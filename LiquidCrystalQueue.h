@@ -0,0 +1,132 @@
+#pragma once
+#include "LiquidCrystalFast.h"
+
+// Non-blocking front end for LiquidCrystalFast. Commands and data are queued
+// in a fixed-size ring and sent from loop() by poll(), one transfer per call
+// and only once the previous instruction has had time to execute, so the
+// caller never busy-waits on the display.
+//
+//   LiquidCrystalQueue<64> screen(lcd);
+//   screen.setCursor(0, 1);
+//   screen.print(temperature);
+//   ...
+//   void loop() { screen.poll(); ... }
+//
+// Anything that doesn't fit in the ring is rejected and counted by
+// getDropped(), so a full queue never blocks either: write() and print()
+// return how many bytes were queued, the other calls false. Don't call the
+// underlying display directly while transfers are pending.
+//
+// SIZE must be a power of two, so that wrapping around the ring is a mask.
+template <uint16_t SIZE = 32> class LiquidCrystalQueue : public Print {
+  static_assert(SIZE > 0 && (SIZE & (SIZE - 1)) == 0,
+                "LiquidCrystalQueue SIZE must be a power of two");
+
+public:
+  LiquidCrystalQueue(LiquidCrystalFast &lcd)
+      : _lcd(lcd), _head(0), _count(0), _wait(0), _sentAt(0), _worstPoll(0),
+        _transfers(0), _dropped(0) {}
+
+  bool command(uint8_t value) { return push(value, LOW); }
+  virtual size_t write(uint8_t value) { return push(value, HIGH) ? 1 : 0; }
+  // queues what fits and drops the rest, rather than stopping at the first
+  // byte that doesn't fit as Print does on some cores
+  virtual size_t write(const uint8_t *buffer, size_t size) {
+    size_t n = 0;
+    for (size_t i = 0; i < size; ++i) {
+      n += push(buffer[i], HIGH) ? 1 : 0;
+    }
+    return n;
+  }
+  using Print::write;
+
+  bool clear() { return command(LCD_CLEARDISPLAY); }
+  bool home() { return command(LCD_RETURNHOME); }
+  bool setCursor(uint8_t col, uint8_t row) {
+    return command(LCD_SETDDRAMADDR | _lcd.cursorAddress(col, row));
+  }
+  bool display() { return control(_lcd._displaycontrol | LCD_DISPLAYON); }
+  bool noDisplay() { return control(_lcd._displaycontrol & ~LCD_DISPLAYON); }
+  bool cursor() { return control(_lcd._displaycontrol | LCD_CURSORON); }
+  bool noCursor() { return control(_lcd._displaycontrol & ~LCD_CURSORON); }
+  bool blink() { return control(_lcd._displaycontrol | LCD_BLINKON); }
+  bool noBlink() { return control(_lcd._displaycontrol & ~LCD_BLINKON); }
+  // queues all nine transfers or, if they don't fit, none of them; like
+  // LiquidCrystal, leaves the controller addressing CGRAM, so follow it
+  // with setCursor() before printing
+  bool createChar(uint8_t location, const uint8_t charmap[8]) {
+    if (SIZE - _count < 9) {
+      _dropped += 9;
+      return false;
+    }
+    command(LCD_SETCGRAMADDR | (location & 0x7) << 3);
+    for (int i = 0; i < 8; i++) {
+      push(charmap[i], HIGH);
+    }
+    return true;
+  }
+
+  // Sends the next queued transfer if the controller is ready for it.
+  // Returns true if something was sent.
+  bool poll() {
+    unsigned long now = micros();
+    if (_count == 0 || (unsigned long)(now - _sentAt) < _wait) {
+      return false;
+    }
+    Entry entry = _entries[_head];
+    _head = (_head + 1) & (SIZE - 1);
+    --_count;
+    _wait = _lcd.transfer(entry.value, entry.mode);
+    _sentAt = micros();
+    if (_sentAt - now > _worstPoll) {
+      _worstPoll = _sentAt - now;
+    }
+    ++_transfers;
+    return true;
+  }
+
+  // true once everything queued has been sent and has finished executing
+  bool isDone() const {
+    return _count == 0 && (unsigned long)(micros() - _sentAt) >= _wait;
+  }
+  uint16_t pending() const { return _count; }
+  uint16_t capacity() const { return SIZE; }
+  // transfers rejected because the ring was full
+  unsigned long getDropped() const { return _dropped; }
+  // longest time a single poll() has kept the caller busy
+  unsigned long getWorstPollMicros() const { return _worstPoll; }
+  unsigned long getTransfers() const { return _transfers; }
+
+private:
+  struct Entry {
+    uint8_t value;
+    uint8_t mode;
+  };
+  LiquidCrystalFast &_lcd;
+  Entry _entries[SIZE];
+  uint16_t _head, _count;
+  uint16_t _wait;
+  unsigned long _sentAt, _worstPoll, _transfers, _dropped;
+
+  bool push(uint8_t value, uint8_t mode) {
+    if (_count == SIZE) {
+      ++_dropped;
+      return false;
+    }
+    Entry &entry = _entries[(_head + _count) & (SIZE - 1)];
+    entry.value = value;
+    entry.mode = mode;
+    ++_count;
+    return true;
+  }
+
+  // the display control bits are committed as soon as the change is queued,
+  // so that toggles queued back to back build on each other
+  bool control(uint8_t displaycontrol) {
+    if (!command(LCD_DISPLAYCONTROL | displaycontrol)) {
+      return false;
+    }
+    _lcd._displaycontrol = displaycontrol;
+    return true;
+  }
+};
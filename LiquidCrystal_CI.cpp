@@ -1,15 +1,21 @@
 #include "LiquidCrystal_CI.h"
 #ifdef ARDUINO_CI_COMPILATION_MOCKS
+#include "ci/ObservableDataStream.h"
+#include <fcntl.h>
 #include <inttypes.h>
+#include <new>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <thread>
+#include <unistd.h>
 
 LiquidCrystal_CI::LiquidCrystal_CI(uint8_t rs, uint8_t rw, uint8_t enable,
                                    uint8_t d0, uint8_t d1, uint8_t d2,
                                    uint8_t d3, uint8_t d4, uint8_t d5,
                                    uint8_t d6, uint8_t d7)
     : LiquidCrystal(rs, rw, enable, d0, d1, d2, d3, d4, d5, d6, d7) {
-  init(rs);
+  init(rs, enable);
 }
 
 LiquidCrystal_CI::LiquidCrystal_CI(uint8_t rs, uint8_t enable, uint8_t d0,
@@ -17,135 +23,279 @@ LiquidCrystal_CI::LiquidCrystal_CI(uint8_t rs, uint8_t enable, uint8_t d0,
                                    uint8_t d4, uint8_t d5, uint8_t d6,
                                    uint8_t d7)
     : LiquidCrystal(rs, enable, d0, d1, d2, d3, d4, d5, d6, d7) {
-  init(rs);
+  init(rs, enable);
 }
 
 LiquidCrystal_CI::LiquidCrystal_CI(uint8_t rs, uint8_t rw, uint8_t enable,
                                    uint8_t d0, uint8_t d1, uint8_t d2,
                                    uint8_t d3)
     : LiquidCrystal(rs, rw, enable, d0, d1, d2, d3) {
-  init(rs);
+  init(rs, enable);
 }
 
 LiquidCrystal_CI::LiquidCrystal_CI(uint8_t rs, uint8_t enable, uint8_t d0,
                                    uint8_t d1, uint8_t d2, uint8_t d3)
     : LiquidCrystal(rs, enable, d0, d1, d2, d3) {
-  init(rs);
+  init(rs, enable);
 }
 
-void LiquidCrystal_CI::init(uint8_t rs) {
+LiquidCrystal_CI::LiquidCrystal_CI(const LiquidCrystal_CI &prototype)
+    : LiquidCrystal(prototype) {
+  _rs_pin = prototype._rs_pin;
+  _enable_pin = prototype._enable_pin;
+  _col = prototype._col;
+  _cols = prototype._cols;
+  _row = prototype._row;
+  _rows = prototype._rows;
+  _shift = prototype._shift;
+  _charsize = prototype._charsize;
+  _autoscroll = prototype._autoscroll;
+  _display = prototype._display;
+  _cursor = prototype._cursor;
+  _blink = prototype._blink;
+  _isInCreateChar = false;
+  _lazy = prototype._lazy;
+  _skipBus = prototype._skipBus;
+  _writeMicros = prototype._writeMicros;
+  _concurrent = false;
+  _recordInterleaving = false;
+  _slots = nullptr;
+  _framebuffer = nullptr;
+  _traceObserver = nullptr;
+  _profile = nullptr;
+  _callDepth = 0;
+  _lines = prototype._lines;
+  _pending = prototype._pending;
+  memcpy(_customChars, prototype._customChars, sizeof(_customChars));
+  _displaced = LiquidCrystal_CI::_instances[_rs_pin];
+  LiquidCrystal_CI::_instances[_rs_pin] = this;
+}
+
+void LiquidCrystal_CI::unregister() {
+  LiquidCrystal_CI **link = &LiquidCrystal_CI::_instances[_rs_pin];
+  while (*link && *link != this) {
+    link = &(*link)->_displaced;
+  }
+  if (*link) {
+    *link = _displaced;
+  }
+}
+
+void LiquidCrystal_CI::init(uint8_t rs, uint8_t enable) {
   _rs_pin = rs;
+  _enable_pin = enable;
+  _shift = 0;
   _col = 0;
   _cols = 16;
   _row = 0;
   _rows = 1;
+  _charsize = LCD_5x8DOTS;
   _autoscroll = false;
   _display = false;
   _cursor = false;
   _blink = false;
   _isInCreateChar = false;
+  _lazy = false;
+  _skipBus = false;
+  _writeMicros = 0;
+  _concurrent = false;
+  _recordInterleaving = false;
+  _slots = nullptr;
+  _framebuffer = nullptr;
+  _traceObserver = nullptr;
+  _profile = nullptr;
+  _callDepth = 0;
   _lines.clear();
   _lines.resize(_rows);
+  _pending.clear();
   for (int character = 0; character < 8; character++) {
     for (int bite = 0; bite < 8; bite++) {
       _customChars[character][bite] = B00000;
     }
   }
+  _displaced = LiquidCrystal_CI::_instances[_rs_pin];
   LiquidCrystal_CI::_instances[_rs_pin] = this;
 }
 
 void LiquidCrystal_CI::begin(uint8_t cols, uint8_t lines, uint8_t dotsize) {
+  CallSpan span(this, "begin", __builtin_return_address(0));
   LiquidCrystal::begin(cols, lines, dotsize);
   _col = 0;
   _cols = cols;
   _row = 0;
   _rows = lines;
+  _shift = 0;
+  _charsize = dotsize;
   _autoscroll = false;
-  _display = false;
+  // LiquidCrystal::begin() ends by turning the display on
+  _display = true;
   _cursor = false;
   _blink = false;
   _isInCreateChar = false;
   _lines.clear();
   _lines.resize(_rows);
+  _pending.clear();
+  publish();
 }
 
 /********** high level commands, for the user! */
 void LiquidCrystal_CI::clear() {
+  CallSpan span(this, "clear", __builtin_return_address(0));
+  if (defer(CALL_CLEAR)) {
+    return;
+  }
   LiquidCrystal::clear();
-  _lines.clear();
-  _lines.resize(_rows);
+  record(OP_CLEAR);
+  publish();
 }
 
 void LiquidCrystal_CI::home() {
+  CallSpan span(this, "home", __builtin_return_address(0));
+  if (defer(CALL_HOME)) {
+    return;
+  }
   LiquidCrystal::home();
-  _col = _row = 0;
+  record(OP_HOME);
+  publish();
 }
 
 void LiquidCrystal_CI::setCursor(uint8_t col, uint8_t row) {
+  CallSpan span(this, "setCursor", __builtin_return_address(0));
+  if (defer(CALL_SET_CURSOR, col, row)) {
+    return;
+  }
   LiquidCrystal::setCursor(col, row);
-  _col = col;
-  _row = row;
+  record(OP_SET_CURSOR, col, row);
+  publish();
 }
 
 // Turn the display on/off (quickly)
 void LiquidCrystal_CI::noDisplay() {
+  CallSpan span(this, "noDisplay", __builtin_return_address(0));
+  if (defer(CALL_NO_DISPLAY)) {
+    return;
+  }
   LiquidCrystal::noDisplay();
   _display = false;
+  publish();
 }
 void LiquidCrystal_CI::display() {
+  CallSpan span(this, "display", __builtin_return_address(0));
+  if (defer(CALL_DISPLAY)) {
+    return;
+  }
   LiquidCrystal::display();
   _display = true;
+  publish();
 }
 
 // Turns the underline cursor on/off
 void LiquidCrystal_CI::noCursor() {
+  CallSpan span(this, "noCursor", __builtin_return_address(0));
+  if (defer(CALL_NO_CURSOR)) {
+    return;
+  }
   LiquidCrystal::noCursor();
   _cursor = false;
+  publish();
 }
 void LiquidCrystal_CI::cursor() {
+  CallSpan span(this, "cursor", __builtin_return_address(0));
+  if (defer(CALL_CURSOR)) {
+    return;
+  }
   LiquidCrystal::cursor();
   _cursor = true;
+  publish();
 }
 
 // Turn on and off the blinking cursor
 void LiquidCrystal_CI::noBlink() {
+  CallSpan span(this, "noBlink", __builtin_return_address(0));
+  if (defer(CALL_NO_BLINK)) {
+    return;
+  }
   LiquidCrystal::noBlink();
   _blink = false;
+  publish();
 }
 void LiquidCrystal_CI::blink() {
+  CallSpan span(this, "blink", __builtin_return_address(0));
+  if (defer(CALL_BLINK)) {
+    return;
+  }
   LiquidCrystal::blink();
   _blink = true;
+  publish();
 }
 
 // These commands scroll the display without changing the RAM
 void LiquidCrystal_CI::scrollDisplayLeft() {
+  CallSpan span(this, "scrollDisplayLeft", __builtin_return_address(0));
+  if (defer(CALL_SCROLL_LEFT)) {
+    return;
+  }
   LiquidCrystal::scrollDisplayLeft();
+  record(OP_SHIFT, true);
+  publish();
 }
 void LiquidCrystal_CI::scrollDisplayRight() {
+  CallSpan span(this, "scrollDisplayRight", __builtin_return_address(0));
+  if (defer(CALL_SCROLL_RIGHT)) {
+    return;
+  }
   LiquidCrystal::scrollDisplayRight();
+  record(OP_SHIFT, false);
+  publish();
 }
 
 // This is for text that flows Left to Right
-void LiquidCrystal_CI::leftToRight() { LiquidCrystal::leftToRight(); }
+void LiquidCrystal_CI::leftToRight() {
+  CallSpan span(this, "leftToRight", __builtin_return_address(0));
+  if (defer(CALL_LEFT_TO_RIGHT)) {
+    return;
+  }
+  LiquidCrystal::leftToRight();
+}
 
 // This is for text that flows Right to Left
-void LiquidCrystal_CI::rightToLeft() { LiquidCrystal::rightToLeft(); }
+void LiquidCrystal_CI::rightToLeft() {
+  CallSpan span(this, "rightToLeft", __builtin_return_address(0));
+  if (defer(CALL_RIGHT_TO_LEFT)) {
+    return;
+  }
+  LiquidCrystal::rightToLeft();
+}
 
 // This will 'right justify' text from the cursor
 void LiquidCrystal_CI::autoscroll() {
+  CallSpan span(this, "autoscroll", __builtin_return_address(0));
+  if (defer(CALL_AUTOSCROLL)) {
+    return;
+  }
   LiquidCrystal::autoscroll();
-  _autoscroll = true;
+  record(OP_AUTOSCROLL, true);
+  publish();
 }
 
 // This will 'left justify' text from the cursor
 void LiquidCrystal_CI::noAutoscroll() {
+  CallSpan span(this, "noAutoscroll", __builtin_return_address(0));
+  if (defer(CALL_NO_AUTOSCROLL)) {
+    return;
+  }
   LiquidCrystal::noAutoscroll();
-  _autoscroll = false;
+  record(OP_AUTOSCROLL, false);
+  publish();
 }
 
 // Allows us to fill the first 8 CGRAM locations
 // with custom characters
 void LiquidCrystal_CI::createChar(uint8_t location, uint8_t charmap[]) {
+  CallSpan span(this, "createChar", __builtin_return_address(0));
+  if (defer(CALL_CREATE_CHAR, location, 0, charmap)) {
+    return;
+  }
   _isInCreateChar = true;
   LiquidCrystal::createChar(location, charmap);
   _isInCreateChar = false;
@@ -153,13 +303,338 @@ void LiquidCrystal_CI::createChar(uint8_t location, uint8_t charmap[]) {
   for (int line = 0; line < 8; line++) {
     _customChars[location][line] = charmap[line];
   }
+  publish();
 }
 
 inline size_t LiquidCrystal_CI::write(uint8_t value) {
-  if (!_isInCreateChar) {
-    String line = _lines.at(_row);
+  CallSpan span(this, "write", __builtin_return_address(0));
+  if (defer(CALL_WRITE, value)) {
+    return 1;
+  }
+  if (_isInCreateChar) {
+    return LiquidCrystal::write(value);
+  }
+  record(OP_WRITE, value);
+  if (_skipBus && _writeMicros && !_traceObserver && !_profile) {
+    delayMicroseconds(_writeMicros);
+    publish();
+    return 1;
+  }
+  unsigned long start = micros();
+  size_t written = LiquidCrystal::write(value);
+  _writeMicros = micros() - start;
+  publish();
+  return written;
+}
+
+// override lower-level write to capture output
+size_t LiquidCrystal_CI::write(const char *buffer, size_t size) {
+  return LiquidCrystal::write(buffer, size);
+}
+
+size_t LiquidCrystal_CI::write(const uint8_t *buffer, size_t size) {
+  CallSpan span(this, "print", __builtin_return_address(0));
+  return LiquidCrystal::write(buffer, size);
+}
+
+std::vector<String> LiquidCrystal_CI::getLinesUTF8(LCDRom rom) {
+  Settle settle(this);
+  std::vector<String> lines(_lines.size());
+  for (size_t row = 0; row < _lines.size(); ++row) {
+    const String &line = _lines[row];
+    String &text = lines[row];
+    text.reserve(line.length() * 3);
+    for (size_t col = 0; col < line.length(); ++col) {
+      char utf8[6];
+      if (rom == LCD_ROM_A02) {
+        LCDCharset<LCD_ROM_A02>::toUTF8(line[col], utf8);
+      } else {
+        LCDCharset<LCD_ROM_A00>::toUTF8(line[col], utf8);
+      }
+      text += utf8;
+    }
+  }
+  return lines;
+}
+
+std::vector<String> LiquidCrystal_CI::getVisibleLines() {
+  Settle settle(this);
+  std::vector<String> lines(_lines.size());
+  for (size_t row = 0; row < _lines.size(); ++row) {
+    const String &line = _lines[row];
+    String &text = lines[row];
+    text.reserve(_cols);
+    for (int col = 0; col < _cols; ++col) {
+      size_t address = (col + _shift) % 40;
+      text += address < line.length() ? line[address] : ' ';
+    }
+  }
+  return lines;
+}
+
+bool LiquidCrystal_CI::matches(const ScreenPattern &pattern) {
+  Settle settle(this);
+  if (!pattern.isValid() || pattern.getRows() > _rows) {
+    return false;
+  }
+  for (int row = 0; row < pattern.getRows(); ++row) {
+    const String &line = _lines[row];
+    if (!pattern.matchesRow(row, (const uint8_t *)line.data(),
+                            line.length())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool LiquidCrystal_CI::publishTo(const char *path) {
+  stopPublishing();
+  // not truncated, so a viewer that has the file from an earlier run mapped
+  // keeps working and picks up the new frames
+  int fd = open(path, O_RDWR | O_CREAT, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  void *mapped = MAP_FAILED;
+  if (ftruncate(fd, sizeof(LCDFramebuffer)) == 0) {
+    mapped = mmap(nullptr, sizeof(LCDFramebuffer), PROT_READ | PROT_WRITE,
+                  MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    return false;
+  }
+  LCDFramebuffer *framebuffer = (LCDFramebuffer *)mapped;
+  if (framebuffer->isValid()) {
+    // even again if an earlier writer died mid-update
+    uint32_t sequence = framebuffer->sequence.load();
+    framebuffer->sequence.store(sequence + (sequence & 1));
+  } else {
+    framebuffer = new (mapped) LCDFramebuffer();
+    framebuffer->size = sizeof(LCDFramebuffer);
+    memcpy(framebuffer->magic, "LCD1", 4);
+  }
+  _framebuffer = framebuffer;
+  publishFrame();
+  return true;
+}
+
+void LiquidCrystal_CI::stopPublishing() {
+  if (_framebuffer) {
+    munmap(_framebuffer, sizeof(LCDFramebuffer));
+    _framebuffer = nullptr;
+  }
+}
+
+void LiquidCrystal_CI::removeListener(Listener *listener) {
+  for (size_t i = 0; i < _listeners.size(); ++i) {
+    if (_listeners[i] == listener) {
+      _listeners.erase(_listeners.begin() + i);
+      return;
+    }
+  }
+}
+
+// Turns enable pulses into transfer spans, and the time from the start of
+// a call or the end of a pulse to the next pulse into delay spans.
+class LiquidCrystal_CI::TraceObserver : public DataStreamObserver {
+public:
+  TraceObserver(LCDTraceWriter *writer, uint8_t rs, uint32_t track)
+      : DataStreamObserver(false, false), _writer(writer), _rs(rs),
+        _track(track), _depth(0), _high(false), _waiting(false) {}
+
+  virtual void onBit(bool aBit) {
+    unsigned long now = micros();
+    if (aBit && !_high) {
+      endDelay(now);
+      _high = true;
+      _pulseStart = now;
+    } else if (!aBit && _high) {
+      _high = false;
+      bool data = GODMODE()->digitalPin[_rs];
+      _writer->complete(data ? "data" : "instruction", "transfer",
+                        _pulseStart, now - _pulseStart, _track);
+      startDelay(now);
+    }
+  }
+
+  virtual String observerName() const { return "LiquidCrystal_CI trace"; }
+
+  void beginCall(const char *name) {
+    if (_depth++ == 0) {
+      _call = name;
+      _callStart = micros();
+      startDelay(_callStart);
+    }
+  }
+  void endCall() {
+    if (--_depth == 0) {
+      unsigned long now = micros();
+      endDelay(now);
+      _writer->complete(_call, "call", _callStart, now - _callStart,
+                        _track);
+    }
+  }
+
+private:
+  LCDTraceWriter *_writer;
+  uint8_t _rs;
+  uint32_t _track;
+  unsigned _depth;
+  const char *_call;
+  unsigned long _callStart, _pulseStart, _delayStart;
+  bool _high, _waiting;
+
+  // delays are only traced inside a call
+  void startDelay(unsigned long now) {
+    _waiting = _depth > 0;
+    _delayStart = now;
+  }
+  void endDelay(unsigned long now) {
+    if (_waiting && now > _delayStart) {
+      _writer->complete("delay", "delay", _delayStart, now - _delayStart,
+                        _track);
+    }
+    _waiting = false;
+  }
+};
+
+void LiquidCrystal_CI::traceTo(LCDTraceWriter *writer) {
+  if (_traceObserver) {
+    GODMODE()->digitalPin[_enable_pin].removeObserver("LiquidCrystal_CI trace");
+    delete _traceObserver;
+    _traceObserver = nullptr;
+  }
+  if (writer) {
+    // displays on one bus share rs and the data pins; only enable is their
+    // own
+    char name[20];
+    snprintf(name, sizeof(name), "LCD enable %d", _enable_pin);
+    writer->nameTrack(_enable_pin, name);
+    _traceObserver = new TraceObserver(writer, _rs_pin, _enable_pin);
+    GODMODE()->digitalPin[_enable_pin].addObserver("LiquidCrystal_CI trace",
+                                                   _traceObserver);
+  }
+}
+
+void LiquidCrystal_CI::profileTo(LCDCallSiteProfile *profile) {
+  if (_profile) {
+    GODMODE()->digitalPin[_enable_pin].removeObserver("LCDCallSiteProfile");
+  }
+  _profile = profile;
+  if (_profile) {
+    GODMODE()->digitalPin[_enable_pin].addObserver("LCDCallSiteProfile",
+                                                   _profile);
+  }
+}
+
+LiquidCrystal_CI::CallSpan::CallSpan(LiquidCrystal_CI *lcd, const char *name,
+                                     const void *site)
+    : _lcd(nullptr), _observer(nullptr), _profile(nullptr),
+      _outermost(!_callerSite) {
+  // the site of the outermost call on this thread, which a queued call
+  // carries to the thread that applies it
+  if (_outermost) {
+    _callerSite = site;
+  }
+  // in concurrent mode a call is only queued here; its span is opened
+  // when it is applied, by the thread holding the applier lock
+  if (lcd->_concurrent && !_applying) {
+    return;
+  }
+  _lcd = lcd;
+  _observer = lcd->_traceObserver;
+  if (_observer) {
+    _observer->beginCall(name);
+  }
+  // only calls from outside are charged to their site
+  if (_lcd->_callDepth++ == 0 && _lcd->_profile) {
+    _profile = _lcd->_profile;
+    _site = _callerSite;
+    _start = micros();
+    _pulses = _profile->getPulses();
+  }
+}
+
+LiquidCrystal_CI::CallSpan::~CallSpan() {
+  if (_lcd) {
+    --_lcd->_callDepth;
+  }
+  if (_profile) {
+    _profile->add(_site, micros() - _start, _profile->getPulses() - _pulses);
+  }
+  if (_observer) {
+    _observer->endCall();
+  }
+  if (_outermost) {
+    _callerSite = nullptr;
+  }
+}
+
+// private data and functions to support testing
+
+void LiquidCrystal_CI::getFrame(LCDFrame *frame) {
+  Settle settle(this);
+  frame->micros = micros();
+  frame->rsPin = _rs_pin;
+  frame->cols = _cols < 40 ? _cols : 40;
+  frame->rows = _rows < 4 ? _rows : 4;
+  frame->cursorCol = _col;
+  frame->cursorRow = _row;
+  frame->flags = (_display ? LCD_FRAME_DISPLAY : 0) |
+                 (_cursor ? LCD_FRAME_CURSOR : 0) |
+                 (_blink ? LCD_FRAME_BLINK : 0) |
+                 (_autoscroll ? LCD_FRAME_AUTOSCROLL : 0);
+  frame->shift = _shift;
+  memset(frame->grid, ' ', sizeof(frame->grid));
+  for (int row = 0; row < frame->rows; ++row) {
+    size_t length = _lines[row].length();
+    memcpy(frame->grid[row], _lines[row].data(), length < 40 ? length : 40);
+  }
+  memcpy(frame->cgram, _customChars, sizeof(frame->cgram));
+}
+
+void LiquidCrystal_CI::publishFrame() {
+  _framebuffer->beginWrite();
+  getFrame(&_framebuffer->frame);
+  ++_framebuffer->frame.updates;
+  _framebuffer->endWrite();
+}
+
+void LiquidCrystal_CI::notifyListeners() {
+  materialize();
+  // a copy, so a listener can remove itself
+  std::vector<Listener *> listeners = _listeners;
+  for (size_t i = 0; i < listeners.size(); ++i) {
+    listeners[i]->onUpdate(*this);
+  }
+}
+
+void LiquidCrystal_CI::record(uint8_t op, uint8_t a, uint8_t b) {
+  ShadowOp record = {op, a, b};
+  if (_lazy) {
+    if (_pending.size() == LAZY_LIMIT) {
+      materializePending();
+    }
+    _pending.push_back(record);
+  } else {
+    apply(record);
+  }
+}
+
+void LiquidCrystal_CI::materializePending() {
+  for (size_t i = 0; i < _pending.size(); ++i) {
+    apply(_pending[i]);
+  }
+  _pending.clear();
+}
+
+void LiquidCrystal_CI::apply(const ShadowOp &op) {
+  switch (op.op) {
+  case OP_WRITE: {
+    String &line = _lines.at(_row);
     int end = _autoscroll ? (_col - 1) : _col;
-    while (line.length() <= end) {
+    while ((int)line.length() <= end) {
       line += ' ';
     }
 
@@ -170,21 +645,224 @@ inline size_t LiquidCrystal_CI::write(uint8_t value) {
       --_col;
     }
 
-    line.at(_col) = value;
+    line.at(_col) = op.a;
     ++_col;
+    break;
+  }
+  case OP_SET_CURSOR:
+    _col = op.a;
+    _row = op.b;
+    break;
+  case OP_HOME:
+    _col = _row = 0;
+    _shift = 0;
+    break;
+  case OP_CLEAR:
+    _lines.clear();
+    _lines.resize(_rows);
+    _shift = 0;
+    break;
+  case OP_AUTOSCROLL:
+    _autoscroll = op.a;
+    break;
+  case OP_SHIFT:
+    // left moves the window to higher addresses
+    _shift = (_shift + (op.a ? 1 : 39)) % 40;
+    break;
+  }
+}
 
-    _lines.at(_row) = line;
+// concurrent mode: a bounded multi-producer queue (Vyukov's design, with a
+// single consumer). Producers only CAS the tail; when the queue is full a
+// producer applies queued calls itself if no one else is, else it yields.
+
+void LiquidCrystal_CI::setConcurrent(bool concurrent, size_t capacity,
+                                     bool recordInterleaving) {
+  if (_concurrent) {
+    applyPending();
+    _concurrent = false;
+    delete[] _slots;
+    _slots = nullptr;
+  }
+  if (concurrent) {
+    size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    _slots = new Slot[size];
+    for (size_t i = 0; i < size; ++i) {
+      _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    _mask = size - 1;
+    _head = 0;
+    _tail.store(0);
+    _applier.store(false);
+    _interleaving.clear();
+    _recordInterleaving = recordInterleaving;
+    _concurrent = true;
   }
-  return LiquidCrystal::write(value);
 }
 
-// override lower-level write to capture output
-size_t LiquidCrystal_CI::write(const char *buffer, size_t size) {
-  return LiquidCrystal::write(buffer, size);
+bool LiquidCrystal_CI::defer(uint8_t method, uint8_t a, uint8_t b,
+                             const uint8_t *charmap) {
+  if (!_concurrent || _applying) {
+    return false;
+  }
+  size_t position = _tail.load(std::memory_order_relaxed);
+  Slot *slot;
+  for (;;) {
+    slot = &_slots[position & _mask];
+    size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+    if (difference == 0) {
+      if (_tail.compare_exchange_weak(position, position + 1,
+                                      std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (difference < 0) {
+      // full
+      applyPending();
+      std::this_thread::yield();
+      position = _tail.load(std::memory_order_relaxed);
+    } else {
+      position = _tail.load(std::memory_order_relaxed);
+    }
+  }
+  TaskCall call = {_task, method, a, b};
+  slot->call.call = call;
+  slot->call.site = _callerSite;
+  if (charmap) {
+    memcpy(slot->call.charmap, charmap, 8);
+  }
+  slot->sequence.store(position + 1, std::memory_order_release);
+  return true;
 }
 
-// private data and functions to support testing
+void LiquidCrystal_CI::applyPending() {
+  if (!_concurrent || _applier.exchange(true, std::memory_order_acquire)) {
+    return;
+  }
+  applyQueued();
+  _applier.store(false, std::memory_order_release);
+}
+
+// caller holds the applier lock
+void LiquidCrystal_CI::applyQueued() {
+  _applying = true;
+  for (;;) {
+    Slot &slot = _slots[_head & _mask];
+    if (slot.sequence.load(std::memory_order_acquire) != _head + 1) {
+      break;
+    }
+    Call queued = slot.call;
+    slot.sequence.store(_head + _mask + 1, std::memory_order_release);
+    ++_head;
+    call(queued);
+    if (_recordInterleaving) {
+      _interleaving.push_back(queued.call);
+    }
+  }
+  _applying = false;
+}
+
+void LiquidCrystal_CI::call(const Call &queued) {
+  const TaskCall &call = queued.call;
+  // charged to the code that queued it
+  const void *site = _callerSite;
+  _callerSite = queued.site;
+  switch (call.method) {
+  case CALL_WRITE:
+    write(call.a);
+    break;
+  case CALL_SET_CURSOR:
+    setCursor(call.a, call.b);
+    break;
+  case CALL_CLEAR:
+    clear();
+    break;
+  case CALL_HOME:
+    home();
+    break;
+  case CALL_DISPLAY:
+    display();
+    break;
+  case CALL_NO_DISPLAY:
+    noDisplay();
+    break;
+  case CALL_CURSOR:
+    cursor();
+    break;
+  case CALL_NO_CURSOR:
+    noCursor();
+    break;
+  case CALL_BLINK:
+    blink();
+    break;
+  case CALL_NO_BLINK:
+    noBlink();
+    break;
+  case CALL_SCROLL_LEFT:
+    scrollDisplayLeft();
+    break;
+  case CALL_SCROLL_RIGHT:
+    scrollDisplayRight();
+    break;
+  case CALL_LEFT_TO_RIGHT:
+    leftToRight();
+    break;
+  case CALL_RIGHT_TO_LEFT:
+    rightToLeft();
+    break;
+  case CALL_AUTOSCROLL:
+    autoscroll();
+    break;
+  case CALL_NO_AUTOSCROLL:
+    noAutoscroll();
+    break;
+  case CALL_CREATE_CHAR: {
+    uint8_t charmap[8];
+    memcpy(charmap, queued.charmap, 8);
+    createChar(call.a, charmap);
+    break;
+  }
+  }
+  _callerSite = site;
+}
+
+String LiquidCrystal_CI::getTaskOutput(uint8_t task) {
+  Settle settle(this);
+  String output;
+  for (size_t i = 0; i < _interleaving.size(); ++i) {
+    if (_interleaving[i].task == task &&
+        _interleaving[i].method == CALL_WRITE) {
+      output += (char)_interleaving[i].a;
+    }
+  }
+  return output;
+}
+
+LiquidCrystal_CI::Settle::Settle(LiquidCrystal_CI *lcd) : _lcd(lcd) {
+  // a listener called by the applier already holds the lock
+  _locked = _lcd->_concurrent && !_applying;
+  if (_locked) {
+    while (_lcd->_applier.exchange(true, std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+    _lcd->applyQueued();
+  }
+  _lcd->materialize();
+}
+
+LiquidCrystal_CI::Settle::~Settle() {
+  if (_locked) {
+    _lcd->_applier.store(false, std::memory_order_release);
+  }
+}
 
+thread_local bool LiquidCrystal_CI::_applying = false;
+thread_local uint8_t LiquidCrystal_CI::_task = 0;
+thread_local const void *LiquidCrystal_CI::_callerSite = nullptr;
+const size_t LiquidCrystal_CI::LAZY_LIMIT;
 LiquidCrystal_CI *LiquidCrystal_CI::_instances[MOCK_PINS_COUNT];
 
 #endif
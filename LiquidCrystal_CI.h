@@ -4,6 +4,12 @@
 #ifndef ARDUINO_CI_COMPILATION_MOCKS
 #define LiquidCrystal_CI LiquidCrystal
 #else
+#include "LCDCallSiteProfile.h"
+#include "LCDCharset.h"
+#include "LCDFramebuffer.h"
+#include "LCDTraceWriter.h"
+#include "ScreenPattern.h"
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -19,7 +25,18 @@ public:
                    uint8_t d1, uint8_t d2, uint8_t d3);
   LiquidCrystal_CI(uint8_t rs, uint8_t enable, uint8_t d0, uint8_t d1,
                    uint8_t d2, uint8_t d3);
-  ~LiquidCrystal_CI() { LiquidCrystal_CI::_instances[_rs_pin] = nullptr; }
+  // Copies the controller and shadow state of an initialized display without
+  // touching the pins, so tests that need many identical displays can skip
+  // the power-on sequence. The copy takes over the rs pin for forRsPin()
+  // until it is destroyed.
+  LiquidCrystal_CI(const LiquidCrystal_CI &prototype);
+  ~LiquidCrystal_CI() {
+    setConcurrent(false);
+    stopPublishing();
+    traceTo(nullptr);
+    profileTo(nullptr);
+    unregister();
+  }
   void begin(uint8_t cols, uint8_t rows, uint8_t charsize = LCD_5x8DOTS);
   void clear();
   void home();
@@ -39,31 +56,268 @@ public:
   void setCursor(uint8_t, uint8_t);
   size_t write(uint8_t);
   size_t write(const char *buffer, size_t size);
+  size_t write(const uint8_t *buffer, size_t size);
+  // Print's print() and println(), called from here so that call site
+  // profiling sees the caller rather than Print
+  template <typename... T>
+  __attribute__((noinline)) size_t print(const T &... args) {
+    CallSpan span(this, "print", __builtin_return_address(0));
+    return Print::print(args...);
+  }
+  template <typename... T>
+  __attribute__((noinline)) size_t println(const T &... args) {
+    CallSpan span(this, "print", __builtin_return_address(0));
+    return Print::println(args...);
+  }
   virtual String className() const { return "LiquidCrystal_CI"; }
 
   // testing methods
   static LiquidCrystal_CI *forRsPin(uint8_t rs) {
     return (LiquidCrystal_CI *)LiquidCrystal_CI::_instances[rs];
   }
-  std::vector<String> getLines() { return _lines; }
+  std::vector<String> getLines() {
+    Settle settle(this);
+    return _lines;
+  }
+  // the lines as UTF-8, read through a character ROM; custom characters
+  // show as ⓪ to ⑦
+  std::vector<String> getLinesUTF8(LCDRom rom = LCD_ROM_A00);
   int getRows() { return _rows; }
-  bool isAutoscroll() { return _autoscroll; }
-  bool isBlink() { return _blink; }
-  bool isCursor() { return _cursor; }
-  bool isDisplay() { return _display; }
+  int getCols() { return _cols; }
+  bool isAutoscroll() {
+    Settle settle(this);
+    return _autoscroll;
+  }
+  bool isBlink() {
+    Settle settle(this);
+    return _blink;
+  }
+  bool isCursor() {
+    Settle settle(this);
+    return _cursor;
+  }
+  bool isDisplay() {
+    Settle settle(this);
+    return _display;
+  }
   byte *getCustomCharacter(uint8_t customChar) {
+    Settle settle(this);
     return _customChars[customChar];
   }
-  int getCursorCol() { return _col; }
-  int getCursorRow() { return _row; }
+  int getCursorCol() {
+    Settle settle(this);
+    return _col;
+  }
+  int getCursorRow() {
+    Settle settle(this);
+    return _row;
+  }
+  // how many columns scrollDisplayLeft() has moved the window over DDRAM,
+  // 0 to 39; clear() and home() reset it
+  int getShift() {
+    Settle settle(this);
+    return _shift;
+  }
+  // The lines as seen through the shifted window: getCols() characters
+  // from column getShift() of each 40-character DDRAM line, wrapping at its
+  // end. Rows are modelled independently, so on four-line displays, where
+  // lines 3 and 4 are the back halves of lines 1 and 2, only unshifted
+  // windows are exact.
+  std::vector<String> getVisibleLines();
+  // Copies the shadow state, stamped with micros(), without allocating.
+  // frame->updates is left as it is.
+  void getFrame(LCDFrame *frame);
+  // compares the pattern against the shadow lines in place
+  bool matches(const ScreenPattern &pattern);
+  // In lazy mode text and cursor changes are only recorded; the lines and
+  // cursor are rebuilt the next time one of the accessors above is called,
+  // or once LAZY_LIMIT changes are waiting, so memory stays bounded in long
+  // runs that never look.
+  // With skipBus, lazy writes also skip the pins while the display isn't
+  // traced or profiled: micros() advances by as much as the last write sent
+  // over the pins took, but pin observers and histories don't see the
+  // characters. For long runs that only look at the text.
+  static const size_t LAZY_LIMIT = 1024;
+  void setLazy(bool lazy, bool skipBus = false) {
+    materialize();
+    _lazy = lazy;
+    _skipBus = lazy && skipBus;
+  }
+  bool isLazy() { return _lazy; }
+  size_t getPendingCount() { return _pending.size(); }
+  // Sends the begin() sequence for the current geometry to the pins without
+  // changing the shadow state, for checking the pin trace of a copy.
+  void replayInit() { LiquidCrystal::begin(_cols, _rows, _charsize); }
+
+  // Mirrors the shadow state into a memory-mapped LCDFramebuffer file after
+  // every call, for a viewer in another process (extras/lcdview). Returns
+  // false if the file can't be created. In lazy mode each call is then
+  // materialized straight away.
+  bool publishTo(const char *path);
+  void stopPublishing();
+
+  // Called after every call that changes the shadow state, with the shadow
+  // up to date, so the accessors above can be used from onUpdate().
+  class Listener {
+  public:
+    virtual ~Listener() {}
+    virtual void onUpdate(LiquidCrystal_CI &lcd) = 0;
+  };
+  void addListener(Listener *listener) { _listeners.push_back(listener); }
+  void removeListener(Listener *listener);
+
+  // Writes a span for every call to the trace, with a nested span for each
+  // enable pulse (a transfer, "instruction" or "data" by the rs pin) and for
+  // the time between pulses (a delay), on a track of its own named after
+  // the enable pin. Calls made by another call, such as the writes inside
+  // print(), are part of the outer call's span. In concurrent mode calls
+  // are traced when they are applied, and print() as single writes, since
+  // it is queued a character at a time. nullptr stops tracing.
+  void traceTo(LCDTraceWriter *writer);
+
+  // Charges the time and enable pulses of every call made from outside the
+  // display to the code that made it; see LCDCallSiteProfile. nullptr
+  // stops profiling.
+  void profileTo(LCDCallSiteProfile *profile);
+
+  // Concurrent mode, for simulating several tasks that share the display
+  // from host threads. The methods above only push the call into a
+  // lock-free queue; calls are applied one at a time, in queue order, by
+  // applyPending() or by the next query. Queries must come from one thread.
+  // With recordInterleaving, every applied call is also kept, without bound,
+  // for getInterleaving() and getTaskOutput(); leave it off for long runs.
+  enum {
+    CALL_WRITE,
+    CALL_SET_CURSOR,
+    CALL_CLEAR,
+    CALL_HOME,
+    CALL_DISPLAY,
+    CALL_NO_DISPLAY,
+    CALL_CURSOR,
+    CALL_NO_CURSOR,
+    CALL_BLINK,
+    CALL_NO_BLINK,
+    CALL_SCROLL_LEFT,
+    CALL_SCROLL_RIGHT,
+    CALL_LEFT_TO_RIGHT,
+    CALL_RIGHT_TO_LEFT,
+    CALL_AUTOSCROLL,
+    CALL_NO_AUTOSCROLL,
+    CALL_CREATE_CHAR
+  };
+  struct TaskCall {
+    uint8_t task, method, a, b;
+  };
+  void setConcurrent(bool concurrent, size_t capacity = 4096,
+                     bool recordInterleaving = false);
+  bool isConcurrent() { return _concurrent; }
+  void applyPending();
+  // tags calls made from the current thread
+  static void setTask(uint8_t task) { _task = task; }
+  // every call applied in concurrent mode, in the order it was applied,
+  // if setConcurrent() was asked to record them
+  std::vector<TaskCall> getInterleaving() {
+    Settle settle(this);
+    return _interleaving;
+  }
+  String getTaskOutput(uint8_t task);
 
 private:
+  enum { OP_WRITE, OP_SET_CURSOR, OP_HOME, OP_CLEAR, OP_AUTOSCROLL, OP_SHIFT };
+  struct ShadowOp {
+    uint8_t op, a, b;
+  };
+  // The displays on an rs pin, newest first, linked through _displaced, so
+  // that destroying one hands forRsPin() back to the one it displaced.
   static LiquidCrystal_CI *_instances[MOCK_PINS_COUNT];
-  int _col, _cols, _row, _rows, _rs_pin;
-  bool _display, _cursor, _blink, _autoscroll, _isInCreateChar;
+  LiquidCrystal_CI *_displaced;
+  void unregister();
+  int _col, _cols, _row, _rows, _rs_pin, _enable_pin, _shift;
+  uint8_t _charsize;
+  bool _display, _cursor, _blink, _autoscroll, _isInCreateChar, _lazy;
+  bool _skipBus;
+  unsigned long _writeMicros; // what the last write over the pins took
   std::vector<String> _lines;
+  std::vector<ShadowOp> _pending;
   byte _customChars[8][8];
-  void init(uint8_t rs);
+  void init(uint8_t rs, uint8_t enable);
+  void record(uint8_t op, uint8_t a = 0, uint8_t b = 0);
+  void apply(const ShadowOp &op);
+  void materialize() {
+    if (!_pending.empty()) {
+      materializePending();
+    }
+  }
+  void materializePending();
+
+  LCDFramebuffer *_framebuffer;
+  std::vector<Listener *> _listeners;
+  void publish() {
+    if (_framebuffer) {
+      publishFrame();
+    }
+    if (!_listeners.empty()) {
+      notifyListeners();
+    }
+  }
+  void publishFrame();
+  void notifyListeners();
+
+  class TraceObserver;
+  TraceObserver *_traceObserver;
+  LCDCallSiteProfile *_profile;
+  int _callDepth;
+  // Around every call, for tracing and profiling; site is the return
+  // address of the public method. Opened before the call is queued in
+  // concurrent mode, where it only notes the site.
+  class CallSpan {
+  public:
+    CallSpan(LiquidCrystal_CI *lcd, const char *name, const void *site);
+    ~CallSpan();
+
+  private:
+    LiquidCrystal_CI *_lcd;
+    TraceObserver *_observer;
+    LCDCallSiteProfile *_profile;
+    const void *_site;
+    unsigned long _start, _pulses;
+    bool _outermost;
+  };
+  static thread_local const void *_callerSite;
+
+  struct Call {
+    TaskCall call;
+    const void *site; // for profiling
+    uint8_t charmap[8];
+  };
+  struct Slot {
+    std::atomic<size_t> sequence;
+    Call call;
+  };
+  static thread_local bool _applying;
+  static thread_local uint8_t _task;
+  bool _concurrent, _recordInterleaving;
+  Slot *_slots;
+  size_t _mask, _head;
+  std::atomic<size_t> _tail;
+  std::atomic<bool> _applier;
+  std::vector<TaskCall> _interleaving;
+  bool defer(uint8_t method, uint8_t a = 0, uint8_t b = 0,
+             const uint8_t *charmap = nullptr);
+  void applyQueued();
+  void call(const Call &call);
+
+  // Brings the shadow up to date for a query, holding the applier lock
+  // while the query reads it.
+  class Settle {
+  public:
+    Settle(LiquidCrystal_CI *lcd);
+    ~Settle();
+
+  private:
+    LiquidCrystal_CI *_lcd;
+    bool _locked;
+  };
 };
 
 #endif
@@ -0,0 +1,156 @@
+#include "LiquidCrystal_CI_C.h"
+#include "LiquidCrystal_CI.h"
+#ifdef ARDUINO_CI_COMPILATION_MOCKS
+#include <string.h>
+
+// the handle is the display itself
+static LiquidCrystal_CI *display(lcd_ci *lcd) {
+  return reinterpret_cast<LiquidCrystal_CI *>(lcd);
+}
+
+lcd_ci *lcd_ci_create(uint8_t rs, uint8_t enable, uint8_t d4, uint8_t d5,
+                      uint8_t d6, uint8_t d7) {
+  return reinterpret_cast<lcd_ci *>(
+      new LiquidCrystal_CI(rs, enable, d4, d5, d6, d7));
+}
+
+lcd_ci *lcd_ci_create_8bit(uint8_t rs, uint8_t enable, uint8_t d0, uint8_t d1,
+                           uint8_t d2, uint8_t d3, uint8_t d4, uint8_t d5,
+                           uint8_t d6, uint8_t d7) {
+  return reinterpret_cast<lcd_ci *>(
+      new LiquidCrystal_CI(rs, enable, d0, d1, d2, d3, d4, d5, d6, d7));
+}
+
+void lcd_ci_destroy(lcd_ci *lcd) { delete display(lcd); }
+
+void lcd_ci_snapshot_of(lcd_ci *lcd, lcd_ci_snapshot *snapshot) {
+  LCDFrame frame;
+  display(lcd)->getFrame(&frame);
+  snapshot->micros = frame.micros;
+  snapshot->cols = frame.cols;
+  snapshot->rows = frame.rows;
+  snapshot->cursor_col = frame.cursorCol;
+  snapshot->cursor_row = frame.cursorRow;
+  // LCD_CI_* match LCD_FRAME_*
+  snapshot->flags = frame.flags;
+  snapshot->shift = frame.shift;
+  memset(snapshot->reserved, 0, sizeof(snapshot->reserved));
+  memcpy(snapshot->lines, frame.grid, sizeof(snapshot->lines));
+  memcpy(snapshot->cgram, frame.cgram, sizeof(snapshot->cgram));
+}
+
+long lcd_ci_run(lcd_ci *handle, const uint8_t *ops, size_t size,
+                lcd_ci_snapshot *snapshots, size_t capacity) {
+  LiquidCrystal_CI *lcd = display(handle);
+  size_t taken = 0, i = 0;
+  while (i < size) {
+    size_t op = i;
+    // bytes after the opcode
+    size_t arguments = 0;
+    switch (ops[op]) {
+    case LCD_CI_OP_BEGIN:
+    case LCD_CI_OP_SET_CURSOR:
+      arguments = 2;
+      break;
+    case LCD_CI_OP_WRITE:
+      arguments = 1;
+      break;
+    case LCD_CI_OP_PRINT:
+      arguments = op + 1 < size ? 1 + ops[op + 1] : 1;
+      break;
+    case LCD_CI_OP_CREATE_CHAR:
+      arguments = 9;
+      break;
+    case LCD_CI_OP_DELAY:
+      arguments = 4;
+      break;
+    case LCD_CI_OP_SNAPSHOT:
+      if (taken == capacity) {
+        return -1 - (long)op;
+      }
+      break;
+    default:
+      if (ops[op] > LCD_CI_OP_SNAPSHOT || ops[op] == 0) {
+        return -1 - (long)op;
+      }
+    }
+    if (arguments > size - op - 1) {
+      return -1 - (long)op;
+    }
+    const uint8_t *a = ops + op + 1;
+    i = op + 1 + arguments;
+    switch (ops[op]) {
+    case LCD_CI_OP_BEGIN:
+      lcd->begin(a[0], a[1]);
+      break;
+    case LCD_CI_OP_CLEAR:
+      lcd->clear();
+      break;
+    case LCD_CI_OP_HOME:
+      lcd->home();
+      break;
+    case LCD_CI_OP_SET_CURSOR:
+      lcd->setCursor(a[0], a[1]);
+      break;
+    case LCD_CI_OP_WRITE:
+      lcd->write(a[0]);
+      break;
+    case LCD_CI_OP_PRINT:
+      lcd->write(a + 1, a[0]);
+      break;
+    case LCD_CI_OP_DISPLAY:
+      lcd->display();
+      break;
+    case LCD_CI_OP_NO_DISPLAY:
+      lcd->noDisplay();
+      break;
+    case LCD_CI_OP_CURSOR:
+      lcd->cursor();
+      break;
+    case LCD_CI_OP_NO_CURSOR:
+      lcd->noCursor();
+      break;
+    case LCD_CI_OP_BLINK:
+      lcd->blink();
+      break;
+    case LCD_CI_OP_NO_BLINK:
+      lcd->noBlink();
+      break;
+    case LCD_CI_OP_SCROLL_LEFT:
+      lcd->scrollDisplayLeft();
+      break;
+    case LCD_CI_OP_SCROLL_RIGHT:
+      lcd->scrollDisplayRight();
+      break;
+    case LCD_CI_OP_LEFT_TO_RIGHT:
+      lcd->leftToRight();
+      break;
+    case LCD_CI_OP_RIGHT_TO_LEFT:
+      lcd->rightToLeft();
+      break;
+    case LCD_CI_OP_AUTOSCROLL:
+      lcd->autoscroll();
+      break;
+    case LCD_CI_OP_NO_AUTOSCROLL:
+      lcd->noAutoscroll();
+      break;
+    case LCD_CI_OP_CREATE_CHAR: {
+      uint8_t charmap[8];
+      memcpy(charmap, a + 1, 8);
+      lcd->createChar(a[0], charmap);
+      break;
+    }
+    case LCD_CI_OP_DELAY:
+      GODMODE()->micros += (unsigned long)a[0] | (unsigned long)a[1] << 8 |
+                           (unsigned long)a[2] << 16 |
+                           (unsigned long)a[3] << 24;
+      break;
+    case LCD_CI_OP_SNAPSHOT:
+      lcd_ci_snapshot_of(handle, &snapshots[taken++]);
+      break;
+    }
+  }
+  return (long)taken;
+}
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef LIQUIDCRYSTAL_CI_C_H
+#define LIQUIDCRYSTAL_CI_C_H
+/* A C interface to LiquidCrystal_CI, for test harnesses in other languages
+ * that load the mocks as a shared library (extras/capi/build.sh). A harness
+ * packs any number of display calls into one byte buffer and runs them with
+ * a single lcd_ci_run(), which can also take snapshots of the display along
+ * the way into memory the caller provides, so a frame costs one crossing
+ * instead of one per call and nothing is allocated for the caller to free.
+ *
+ * Each operation in the buffer is an opcode byte followed by its arguments:
+ *
+ *   LCD_CI_OP_BEGIN        cols, rows
+ *   LCD_CI_OP_SET_CURSOR   col, row
+ *   LCD_CI_OP_WRITE        character
+ *   LCD_CI_OP_PRINT        length (0-255), then length characters
+ *   LCD_CI_OP_CREATE_CHAR  slot, then 8 rows
+ *   LCD_CI_OP_DELAY        microseconds, 4 bytes little-endian; advances
+ *                          the mock clock
+ *   LCD_CI_OP_SNAPSHOT     fills the next snapshot
+ *   all others             none
+ *
+ * Handles are not thread safe, and all displays share the mocks' pins and
+ * clock, so use one rs pin per display. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct lcd_ci lcd_ci;
+
+enum {
+  LCD_CI_OP_BEGIN = 1,
+  LCD_CI_OP_CLEAR,
+  LCD_CI_OP_HOME,
+  LCD_CI_OP_SET_CURSOR,
+  LCD_CI_OP_WRITE,
+  LCD_CI_OP_PRINT,
+  LCD_CI_OP_DISPLAY,
+  LCD_CI_OP_NO_DISPLAY,
+  LCD_CI_OP_CURSOR,
+  LCD_CI_OP_NO_CURSOR,
+  LCD_CI_OP_BLINK,
+  LCD_CI_OP_NO_BLINK,
+  LCD_CI_OP_SCROLL_LEFT,
+  LCD_CI_OP_SCROLL_RIGHT,
+  LCD_CI_OP_LEFT_TO_RIGHT,
+  LCD_CI_OP_RIGHT_TO_LEFT,
+  LCD_CI_OP_AUTOSCROLL,
+  LCD_CI_OP_NO_AUTOSCROLL,
+  LCD_CI_OP_CREATE_CHAR,
+  LCD_CI_OP_DELAY,
+  LCD_CI_OP_SNAPSHOT
+};
+
+/* flags in a snapshot */
+enum {
+  LCD_CI_DISPLAY = 1,
+  LCD_CI_CURSOR = 2,
+  LCD_CI_BLINK = 4,
+  LCD_CI_AUTOSCROLL = 8
+};
+
+typedef struct {
+  uint64_t micros; /* mock clock when taken */
+  uint8_t cols, rows;
+  uint8_t cursor_col, cursor_row;
+  uint8_t flags; /* LCD_CI_* */
+  uint8_t shift; /* display shift, 0 to 39 */
+  uint8_t reserved[2];
+  uint8_t lines[4][40]; /* DDRAM text; blank cells are spaces */
+  uint8_t cgram[8][8];
+} lcd_ci_snapshot;
+
+/* a display in 4-bit mode, or 8-bit with lcd_ci_create_8bit() */
+lcd_ci *lcd_ci_create(uint8_t rs, uint8_t enable, uint8_t d4, uint8_t d5,
+                      uint8_t d6, uint8_t d7);
+lcd_ci *lcd_ci_create_8bit(uint8_t rs, uint8_t enable, uint8_t d0, uint8_t d1,
+                           uint8_t d2, uint8_t d3, uint8_t d4, uint8_t d5,
+                           uint8_t d6, uint8_t d7);
+void lcd_ci_destroy(lcd_ci *lcd);
+
+/* Runs the operations in ops. Returns the number of snapshots written, or,
+ * if an operation is unknown, runs past the end of the buffer or finds no
+ * snapshot left, -1 - its offset; the operations before it have run. */
+long lcd_ci_run(lcd_ci *lcd, const uint8_t *ops, size_t size,
+                lcd_ci_snapshot *snapshots, size_t capacity);
+void lcd_ci_snapshot_of(lcd_ci *lcd, lcd_ci_snapshot *snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,179 @@
+#include "ScreenPattern.h"
+#ifdef ARDUINO_CI_COMPILATION_MOCKS
+#include <string.h>
+
+ScreenPattern::ScreenPattern(const char *row0, const char *row1,
+                             const char *row2, const char *row3) {
+  const char *rows[MAX_ROWS] = {row0, row1, row2, row3};
+  _valid = true;
+  _rows = 0;
+  _classCount = 0;
+  // a row that fails to compile stops early; leave it empty, not undefined
+  memset(_width, 0, sizeof(_width));
+  memset(_rest, 0, sizeof(_rest));
+  memset(_classOf, 0, sizeof(_classOf));
+  memset(_classCells, 0, sizeof(_classCells));
+  for (int row = 0; row < MAX_ROWS && rows[row]; ++row) {
+    _valid = compileRow(row, rows[row]) && _valid;
+    _rows = row + 1;
+  }
+}
+
+bool ScreenPattern::compileRow(int row, const char *text) {
+  int col = 0;
+  _rest[row] = false;
+  while (*text) {
+    if (col == MAX_COLS) {
+      _width[row] = col;
+      return false;
+    }
+    uint8_t value = *text;
+    uint8_t mask = 0xFF;
+    int klass = -1;
+    uint32_t bits[8] = {0};
+    switch (*text) {
+    case '*':
+      if (text[1] == '\0') {
+        _rest[row] = true;
+        ++text;
+        continue;
+      }
+      break;
+    case '?':
+      value = mask = 0;
+      break;
+    case '#':
+      for (int c = '0'; c <= '9'; ++c) {
+        bits[c >> 5] |= 1UL << (c & 31);
+      }
+      klass = addClass(bits);
+      break;
+    case '\\':
+      if (!text[1]) {
+        return false;
+      }
+      value = *++text;
+      break;
+    case '{':
+      if (text[1] < '0' || text[1] > '7' || text[2] != '}') {
+        return false;
+      }
+      value = text[1] - '0';
+      mask = 0xF7; // CGRAM characters repeat at 8..15
+      text += 2;
+      break;
+    case '[': {
+      bool negate = text[1] == '^';
+      const char *p = text + (negate ? 2 : 1);
+      // a ] right after [ or [^ is a member, as in regular expressions
+      const char *first = p;
+      while (*p && (*p != ']' || p == first)) {
+        uint8_t from = *p, to = *p;
+        if (p[1] == '-' && p[2] && p[2] != ']') {
+          to = p[2];
+          p += 2;
+        }
+        for (int c = from; c <= to; ++c) {
+          bits[c >> 5] |= 1UL << (c & 31);
+        }
+        ++p;
+      }
+      if (*p != ']') {
+        return false;
+      }
+      if (negate) {
+        for (int i = 0; i < 8; ++i) {
+          bits[i] = ~bits[i];
+        }
+      }
+      klass = addClass(bits);
+      text = p;
+      break;
+    }
+    }
+    if (klass >= 0) {
+      value = mask = 0;
+      _classOf[row][col] = klass + 1;
+      ++_classCells[row];
+    } else if (klass == -2) {
+      return false;
+    }
+    _value[row][col] = value;
+    _mask[row][col] = mask;
+    ++col;
+    ++text;
+  }
+  _width[row] = col;
+  return true;
+}
+
+int ScreenPattern::addClass(const uint32_t bits[8]) {
+  for (int i = 0; i < _classCount; ++i) {
+    if (!memcmp(_classes[i], bits, sizeof(_classes[i]))) {
+      return i;
+    }
+  }
+  if (_classCount == MAX_CLASSES) {
+    return -2;
+  }
+  memcpy(_classes[_classCount], bits, sizeof(_classes[_classCount]));
+  return _classCount++;
+}
+
+bool ScreenPattern::matchesRow(int row, const uint8_t *text,
+                               size_t length) const {
+  if (row >= _rows) {
+    return true;
+  }
+  size_t width = _width[row];
+  const uint8_t *value = _value[row];
+  const uint8_t *mask = _mask[row];
+  size_t common = length < width ? length : width;
+
+  // eight cells at a time
+  size_t col = 0;
+  for (; col + 8 <= common; col += 8) {
+    uint64_t t, m, v;
+    memcpy(&t, text + col, 8);
+    memcpy(&m, mask + col, 8);
+    memcpy(&v, value + col, 8);
+    if ((t & m) != v) {
+      return false;
+    }
+  }
+  for (; col < common; ++col) {
+    if ((text[col] & mask[col]) != value[col]) {
+      return false;
+    }
+  }
+  // cells the screen never wrote are blank
+  for (; col < width; ++col) {
+    if ((' ' & mask[col]) != value[col]) {
+      return false;
+    }
+  }
+
+  if (_classCells[row]) {
+    const uint8_t *classOf = _classOf[row];
+    for (col = 0; col < width; ++col) {
+      if (classOf[col]) {
+        uint8_t c = col < length ? text[col] : ' ';
+        const uint32_t *bits = _classes[classOf[col] - 1];
+        if (!(bits[c >> 5] & (1UL << (c & 31)))) {
+          return false;
+        }
+      }
+    }
+  }
+
+  if (!_rest[row]) {
+    for (col = width; col < length; ++col) {
+      if (text[col] != ' ') {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// A screen pattern compiled once into per-cell value/mask arrays, so that
+// matching a frame is a masked block comparison with no allocation.
+//
+// Each row is a string of cells:
+//   x        the character x
+//   ?        any character
+//   #        a digit
+//   [...]    a character class, with ranges and ^ negation: [0-9A-F], [^ ]
+//   {n}      custom character n (0-7, also matches its alias n+8)
+//   \x       the character x, for ? # [ { * and \ themselves
+//   *        at the end of a row: anything from here on
+// Cells after the end of a row must be blank (unwritten or a space), unless
+// the row ends with *. Rows not given match anything.
+//
+//   ScreenPattern pattern("Temp: ##.# C", "*");
+//   assertTrue(lcd.matches(pattern));
+class ScreenPattern {
+public:
+  static const int MAX_ROWS = 4;
+  static const int MAX_COLS = 40; // one line of DDRAM
+  static const int MAX_CLASSES = 8;
+
+  ScreenPattern(const char *row0, const char *row1 = nullptr,
+                const char *row2 = nullptr, const char *row3 = nullptr);
+  // false if a row is malformed or too wide, or there are too many classes
+  bool isValid() const { return _valid; }
+  int getRows() const { return _rows; }
+  // Matches one row of screen text; text shorter than the pattern is
+  // treated as blank beyond its end.
+  bool matchesRow(int row, const uint8_t *text, size_t length) const;
+
+private:
+  bool _valid;
+  int _rows;
+  uint8_t _width[MAX_ROWS];
+  bool _rest[MAX_ROWS];
+  uint8_t _value[MAX_ROWS][MAX_COLS];
+  uint8_t _mask[MAX_ROWS][MAX_COLS];
+  // per cell, 0 or 1 + index into _classes
+  uint8_t _classOf[MAX_ROWS][MAX_COLS];
+  uint8_t _classCells[MAX_ROWS];
+  uint32_t _classes[MAX_CLASSES][8];
+  int _classCount;
+
+  bool compileRow(int row, const char *text);
+  int addClass(const uint32_t bits[8]);
+};
@@ -1 +1,20 @@
+// Prints a greeting and the seconds since reset, like the LiquidCrystal
+// HelloWorld example. Under the mocks it runs against LiquidCrystal_CI, so
+// extras/runner can show the screen without hardware.
+//
+// Circuit: rs to pin 12, enable to pin 11, d4..d7 to pins 5, 4, 3, 2
 
+#include <LiquidCrystal_CI.h>
+
+LiquidCrystal_CI lcd(12, 11, 5, 4, 3, 2);
+
+void setup() {
+  lcd.begin(16, 2);
+  lcd.print("hello, world!");
+}
+
+void loop() {
+  lcd.setCursor(0, 1);
+  lcd.print(millis() / 1000);
+  delay(100);
+}
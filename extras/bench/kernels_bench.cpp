@@ -0,0 +1,176 @@
+// Benchmark for LCDScreenKernels: the vector kernels against their scalar
+// versions, and against searching the lines as std::strings, over a large
+// batch of recorded 20x4 frames held contiguously.
+//
+// Build (from the library root):
+//   c++ -O2 -std=c++11 -I. -o kernels_bench extras/bench/kernels_bench.cpp
+//       LCDScreenKernels.cpp
+// Usage:  kernels_bench [frames]   (default 200000)
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "LCDScreenKernels.h"
+
+namespace {
+
+const size_t COLS = 20, ROWS = 4, FRAME = COLS * ROWS;
+
+double seconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+// a clock screen that changes a few cells per frame, with an alarm now and
+// then
+void record(std::vector<uint8_t> &frames, size_t count) {
+  frames.resize(count * FRAME);
+  for (size_t f = 0; f < count; ++f) {
+    // room for the longest formatted row; only COLS of each are kept
+    char text[ROWS][40];
+    snprintf(text[0], sizeof(text[0]), "Time %02zu:%02zu:%02zu",
+             f / 3600 % 24, f / 60 % 60, f % 60);
+    snprintf(text[1], sizeof(text[1]), "Temp %3zu.%zu C", 18 + f / 97 % 8,
+             f % 10);
+    snprintf(text[2], sizeof(text[2]), "%s",
+             f % 5000 == 4999 ? "ALARM pressure" : "");
+    snprintf(text[3], sizeof(text[3]), "Frame %zu", f);
+    for (size_t row = 0; row < ROWS; ++row) {
+      size_t length = strlen(text[row]);
+      memset(text[row] + length, ' ', sizeof(text[row]) - length);
+      memcpy(&frames[f * FRAME + row * COLS], text[row], COLS);
+    }
+  }
+}
+
+struct Result {
+  double seconds;
+  size_t value;
+};
+
+template <typename F> Result run(F body) {
+  std::chrono::steady_clock::time_point start =
+      std::chrono::steady_clock::now();
+  size_t value = body();
+  return Result{seconds(start), value};
+}
+
+void report(const char *name, Result vector, Result scalar, size_t frames) {
+  printf("%-10s %8.2f ns/frame  scalar %8.2f ns/frame  %5.1fx%s\n", name,
+         vector.seconds * 1e9 / frames, scalar.seconds * 1e9 / frames,
+         scalar.seconds / vector.seconds,
+         vector.value == scalar.value ? "" : "  MISMATCH");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  size_t count = argc > 1 ? strtoul(argv[1], NULL, 10) : 200000;
+  std::vector<uint8_t> frames;
+  record(frames, count);
+  const uint8_t *data = &frames[0];
+  const uint8_t needle[] = "ALARM";
+  const size_t length = 5;
+  printf("%zu frames of %zux%zu, %s kernels\n", count, COLS, ROWS,
+         LCDScreenKernels::implementation());
+
+  // every frame showing the needle, searching the whole batch in one pass
+  Result found = run([&] {
+    size_t hits = 0, at = 0;
+    for (;;) {
+      size_t offset = LCDScreenKernels::find(data + at, frames.size() - at,
+                                             needle, length);
+      if (offset == LCDScreenKernels::NOT_FOUND) {
+        return hits;
+      }
+      ++hits;
+      at += offset + 1;
+    }
+  });
+  Result foundScalar = run([&] {
+    size_t hits = 0, at = 0;
+    for (;;) {
+      size_t offset = LCDScreenKernels::findScalar(
+          data + at, frames.size() - at, needle, length);
+      if (offset == LCDScreenKernels::NOT_FOUND) {
+        return hits;
+      }
+      ++hits;
+      at += offset + 1;
+    }
+  });
+  report("find", found, foundScalar, count);
+
+  // the same search through per-line strings, as with getLines()
+  Result strings = run([&] {
+    size_t hits = 0;
+    for (size_t f = 0; f < count; ++f) {
+      for (size_t row = 0; row < ROWS; ++row) {
+        std::string line((const char *)data + f * FRAME + row * COLS, COLS);
+        hits += line.find("ALARM") != std::string::npos;
+      }
+    }
+    return hits;
+  });
+  printf("%-10s %8.2f ns/frame  (%.1fx slower than find)\n", "strings",
+         strings.seconds * 1e9 / count, strings.seconds / found.seconds);
+
+  // each frame against the one before it
+  report("equal", run([&] {
+           size_t same = 0;
+           for (size_t f = 1; f < count; ++f) {
+             same += LCDScreenKernels::equal(data + (f - 1) * FRAME,
+                                             data + f * FRAME, FRAME);
+           }
+           return same;
+         }),
+         run([&] {
+           size_t same = 0;
+           for (size_t f = 1; f < count; ++f) {
+             same += LCDScreenKernels::equalScalar(data + (f - 1) * FRAME,
+                                                   data + f * FRAME, FRAME);
+           }
+           return same;
+         }),
+         count);
+  report("countDiff", run([&] {
+           size_t cells = 0;
+           for (size_t f = 1; f < count; ++f) {
+             cells += LCDScreenKernels::countDiff(data + (f - 1) * FRAME,
+                                                  data + f * FRAME, FRAME);
+           }
+           return cells;
+         }),
+         run([&] {
+           size_t cells = 0;
+           for (size_t f = 1; f < count; ++f) {
+             cells += LCDScreenKernels::countDiffScalar(
+                 data + (f - 1) * FRAME, data + f * FRAME, FRAME);
+           }
+           return cells;
+         }),
+         count);
+  report("firstDiff", run([&] {
+           size_t sum = 0;
+           for (size_t f = 1; f < count; ++f) {
+             sum += LCDScreenKernels::firstDiff(data + (f - 1) * FRAME,
+                                                data + f * FRAME, FRAME);
+           }
+           return sum;
+         }),
+         run([&] {
+           size_t sum = 0;
+           for (size_t f = 1; f < count; ++f) {
+             sum += LCDScreenKernels::firstDiffScalar(data + (f - 1) * FRAME,
+                                                      data + f * FRAME, FRAME);
+           }
+           return sum;
+         }),
+         count);
+  return 0;
+}
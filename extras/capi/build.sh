@@ -0,0 +1,25 @@
+#!/bin/sh
+# Build LiquidCrystal_CI and the arduino_ci mocks as a shared library with the
+# C interface in LiquidCrystal_CI_C.h, then build and run example.c against it.
+#
+#   extras/capi/build.sh 100000
+#
+# ARDUINO_CI defaults to the arduino_ci gem from the Gemfile (bundle install
+# first); LIQUIDCRYSTAL defaults to where arduino_ci installs dependencies.
+# The library is left in OUT for harnesses to load.
+set -e
+LIB=$(cd "$(dirname "$0")/../.." && pwd)
+ARDUINO_CI=${ARDUINO_CI:-$(cd "$LIB" && bundle show arduino_ci)}
+LIQUIDCRYSTAL=${LIQUIDCRYSTAL:-$HOME/Arduino/libraries/LiquidCrystal/src}
+OUT=${OUT:-${TMPDIR:-/tmp}/liquidcrystal_ci}
+mkdir -p "$OUT"
+
+# without interposition calls inside the library can be bound directly
+${CXX:-c++} -std=c++11 -O2 -fPIC -fno-semantic-interposition -shared \
+  -DARDUINO=100 -DARDUINO_CI_COMPILATION_MOCKS \
+  -I"$ARDUINO_CI/cpp/arduino" -I"$LIQUIDCRYSTAL" -I"$LIB" \
+  "$LIB"/*.cpp "$LIQUIDCRYSTAL"/*.cpp "$ARDUINO_CI"/cpp/arduino/*.cpp \
+  -pthread -o "$OUT/libliquidcrystal_ci.so"
+${CC:-cc} -std=c99 -O2 -I"$LIB" "$LIB/extras/capi/example.c" \
+  -L"$OUT" -lliquidcrystal_ci -Wl,-rpath,"$OUT" -o "$OUT/example"
+exec "$OUT/example" "$@"
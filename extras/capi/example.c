@@ -0,0 +1,87 @@
+/* Drives a 16x2 display through the C interface, a batch of frames per call,
+ * and reports the wall time per operation.
+ *
+ *   extras/capi/build.sh [frames]
+ */
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "LiquidCrystal_CI_C.h"
+
+enum { BATCH = 64 };
+
+static double seconds(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+/* appends one frame's operations; returns their count */
+static size_t frame(uint8_t **ops, unsigned long n) {
+  char text[17];
+  uint8_t *p = *ops;
+  size_t length = (size_t)snprintf(text, sizeof(text), "frame %lu", n);
+  *p++ = LCD_CI_OP_SET_CURSOR;
+  *p++ = 0;
+  *p++ = 0;
+  *p++ = LCD_CI_OP_PRINT;
+  *p++ = (uint8_t)length;
+  memcpy(p, text, length);
+  p += length;
+  *p++ = LCD_CI_OP_SET_CURSOR;
+  *p++ = 0;
+  *p++ = 1;
+  *p++ = LCD_CI_OP_WRITE;
+  *p++ = "|/-\\"[n % 4];
+  *p++ = LCD_CI_OP_DELAY;
+  *p++ = 0x10; /* 10 ms */
+  *p++ = 0x27;
+  *p++ = 0;
+  *p++ = 0;
+  *p++ = LCD_CI_OP_SNAPSHOT;
+  *ops = p;
+  return 6;
+}
+
+int main(int argc, char **argv) {
+  unsigned long frames = argc > 1 ? strtoul(argv[1], NULL, 10) : 10000;
+  static uint8_t ops[BATCH * 64];
+  static lcd_ci_snapshot snapshots[BATCH];
+  const uint8_t setup[] = {LCD_CI_OP_BEGIN, 16, 2, LCD_CI_OP_CLEAR};
+  lcd_ci *lcd = lcd_ci_create(1, 3, 14, 15, 16, 17);
+  unsigned long count = 0, done = 0;
+  double start;
+
+  if (lcd_ci_run(lcd, setup, sizeof(setup), NULL, 0) < 0) {
+    return 1;
+  }
+  start = seconds();
+  while (done < frames) {
+    uint8_t *end = ops;
+    unsigned long batch = frames - done < BATCH ? frames - done : BATCH;
+    unsigned long i;
+    long taken;
+    for (i = 0; i < batch; ++i) {
+      count += frame(&end, done + i);
+    }
+    taken = lcd_ci_run(lcd, ops, (size_t)(end - ops), snapshots, BATCH);
+    if (taken != (long)batch) {
+      fprintf(stderr, "lcd_ci_run: %ld\n", taken);
+      return 1;
+    }
+    done += batch;
+  }
+  if (frames) {
+    const lcd_ci_snapshot *last = &snapshots[(frames - 1) % BATCH];
+    double elapsed = seconds() - start;
+    printf("%.16s\n%.16s\n", (const char *)last->lines[0],
+           (const char *)last->lines[1]);
+    printf("%lu frames, %lu operations, %.0f ns per operation\n", frames,
+           count, elapsed * 1e9 / count);
+  }
+  lcd_ci_destroy(lcd);
+  return 0;
+}
@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+"""Generate LCDCharsetTables.h, the character ROM tables behind LCDCharset.
+
+    python3 extras/charset/gen_charset_tables.py > LCDCharsetTables.h
+
+Each ROM is described below as the Unicode text of its 256 codes, from the
+HD44780U datasheet (table 4, ROM codes A00 and A02). From that the script
+derives:
+
+  * a two-level UTF-8 -> ROM table: a 256-entry index by the high byte of a
+    BMP code point, selecting a 256-entry page by the low byte (0 = no
+    glyph), and
+  * a ROM -> UTF-8 table of NUL-terminated byte strings.
+
+Characters the ROM lacks are folded to a close glyph where there is an
+obvious one (accents dropped, full-width katakana to half-width).
+"""
+
+import unicodedata
+
+UNDEFINED = "�"
+# custom characters 0-7, repeated at 8-15
+PLACEHOLDERS = ["⓪"] + [chr(0x2460 + i) for i in range(7)]
+
+
+def ascii_block():
+    return {c: chr(c) for c in range(0x20, 0x7F)}
+
+
+def a00():
+    rom = ascii_block()
+    rom[0x5C] = "¥"  # yen sign
+    rom[0x7E] = "→"
+    rom[0x7F] = "←"
+    rom[0xA0] = " "
+    # JIS X 0201 katakana, in Unicode's half-width forms
+    for c in range(0xA1, 0xE0):
+        rom[c] = chr(0xFF61 + c - 0xA1)
+    upper = ("αäβεμσρg"
+             "√⁻¹jˣ¢£ñö"
+             "pqθ∞ΩüΣπ"
+             "x̄y千万円÷ █")
+    # split into one entry per code: x̄ and ⁻¹ are two chars
+    glyphs = []
+    i = 0
+    while i < len(upper):
+        if upper[i] == "⁻" or upper[i + 1:i + 2] == "̄":
+            glyphs.append(upper[i:i + 2])
+            i += 2
+        else:
+            glyphs.append(upper[i])
+            i += 1
+    assert len(glyphs) == 32, len(glyphs)
+    for c, g in enumerate(glyphs):
+        rom[0xE0 + c] = g
+    aliases = {
+        "°": 0xDF,  # degree sign on the handakuten
+        "µ": 0xE4,  # micro sign
+        "·": 0xA5,
+        "・": 0xA5,
+        "゛": 0xDE,
+        "゜": 0xDF,
+        "゙": 0xDE,  # combining, so decomposed kana work
+        "゚": 0xDF,
+        "。": 0xA1,
+        "「": 0xA2,
+        "」": 0xA3,
+        "、": 0xA4,
+        "ー": 0xB0,
+    }
+    return rom, aliases
+
+
+def a02():
+    rom = ascii_block()
+    low = ("▶◀“”⏫⏬●↵"
+           "↑↓→←≤≥▲▼")
+    for c, g in enumerate(low):
+        rom[0x10 + c] = g
+    rom[0x7F] = "⌂"  # house
+    cyrillic_greek = ("БДЖЗИЙЛП"
+                      "УЦЧШЩЪЫЭ"
+                      "α♪ΓπΣσ♬τ"
+                      "⍾ΘΩδ∞♥ε∩")
+    for c, g in enumerate(cyrillic_greek):
+        rom[0x80 + c] = g
+    # the upper half follows ISO 8859-1
+    for c in range(0xA0, 0x100):
+        rom[c] = chr(c)
+    rom[0xAD] = "‐"
+    aliases = {
+        "μ": 0xB5,  # Greek mu onto the micro sign
+    }
+    return rom, aliases
+
+
+def forward(rom, aliases):
+    table = {}
+    for code in sorted(rom):
+        text = rom[code]
+        if len(text) == 1 and ord(text) < 0x10000 and ord(text) not in table:
+            table[ord(text)] = code
+    for text, code in aliases.items():
+        table.setdefault(ord(text), code)
+    # fold what the ROM lacks onto a glyph it has
+    for cp in (list(range(0xA0, 0x250)) + list(range(0x30A1, 0x30FB)) +
+               list(range(0xFF01, 0xFF5F))):
+        if cp in table:
+            continue
+        ch = chr(cp)
+        for candidate in (unicodedata.normalize("NFKC", ch),
+                          unicodedata.normalize("NFD", ch)[:1]):
+            if len(candidate) == 1 and ord(candidate) in table:
+                table[cp] = table[ord(candidate)]
+                break
+    # full-width katakana onto the half-width forms
+    for cp in range(0xFF61, 0xFFA0):
+        full = unicodedata.normalize("NFKC", chr(cp))
+        if cp in table and len(full) == 1 and ord(full) not in table:
+            table[ord(full)] = table[cp]
+    return table
+
+
+def utf8(text):
+    return text.encode("utf-8")
+
+
+def reverse(rom):
+    table = []
+    for code in range(256):
+        if code < 0x10:
+            table.append(utf8(PLACEHOLDERS[code & 7]))
+        else:
+            table.append(utf8(rom.get(code, UNDEFINED)))
+    assert max(len(t) for t in table) <= 5
+    return table
+
+
+def c_string(data):
+    out = ""
+    after_escape = False
+    for b in data:
+        if b >= 0x80:
+            out += "\\x%02X" % b
+            after_escape = True
+            continue
+        ch = chr(b)
+        if after_escape and ch in "0123456789abcdefABCDEF":
+            out += "\" \""  # a hex escape would swallow the digit
+        out += "\\" + ch if ch in "\\\"" else ch
+        after_escape = False
+    return out
+
+
+def c_bytes(data):
+    return ", ".join("0x%02X" % b for b in data)
+
+
+def emit(name, rom, aliases):
+    table = forward(rom, aliases)
+    pages = sorted({cp >> 8 for cp in table})
+    index = [0] * 256
+    for n, page in enumerate(pages):
+        index[page] = n + 1
+    out = []
+    out.append("static constexpr uint8_t %s_PAGE_INDEX[256] PROGMEM = {" % name)
+    for row in range(0, 256, 16):
+        out.append("    %s," % c_bytes(index[row:row + 16]))
+    out.append("};")
+    out.append("static constexpr uint8_t %s_PAGES[%d][256] PROGMEM = {" %
+               (name, len(pages)))
+    for page in pages:
+        out.append("    {// U+%02X00" % page)
+        values = [table.get((page << 8) | low, 0) for low in range(256)]
+        for row in range(0, 256, 16):
+            out.append("     %s," % c_bytes(values[row:row + 16]))
+        out.append("    },")
+    out.append("};")
+    out.append("static constexpr char %s_UTF8[256][6] PROGMEM = {" % name)
+    for code, text in enumerate(reverse(rom)):
+        out.append("    \"%s\", // 0x%02X" % (c_string(text), code))
+    out.append("};")
+    return "\n".join(out)
+
+
+def main():
+    print("// Generated by extras/charset/gen_charset_tables.py; do not edit.")
+    print("// Included only by LCDCharset.cpp.")
+    print("#pragma once")
+    print()
+    print(emit("LCD_A00", *a00()))
+    print()
+    print(emit("LCD_A02", *a02()))
+
+
+if __name__ == "__main__":
+    main()
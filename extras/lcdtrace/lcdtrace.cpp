@@ -0,0 +1,424 @@
+// lcdtrace: decode a captured HD44780 pin trace into an instruction listing.
+//
+// Each trace word is one enable pulse, packed the way test/test.cpp's
+// BitCollector packs it:
+//
+//   bit 9: rs   bit 8: rw   bits 7..0: d7..d0
+//
+// so the expected{48, 48, 48, 32, ...} arrays in the tests can be pasted
+// into a file as they are. The controller starts in 8-bit interface mode,
+// as after power-on; a function set with DL=0 switches it to 4-bit mode,
+// after which words are taken in pairs from d7..d4. The decoder keeps a
+// model of DDRAM, CGRAM and the display shift so it can show the screen.
+//
+// Build:  c++ -O2 -std=c++11 -o lcdtrace lcdtrace.cpp
+// Usage:  lcdtrace [options] [trace-file]   (reads stdin without a file)
+//
+//   -b            trace is binary: little-endian 16-bit words
+//   -4            interface is already in 4-bit mode when the trace starts
+//   -c COLS       screen width for the screen view (default 16)
+//   -r ROWS       screen height for the screen view (default 2)
+//   -s            print the screen after every instruction
+//   -q            no listing, only the final screen and the totals
+//
+// Text traces may separate numbers with anything that isn't a digit
+// (spaces, commas, braces), so a whole test source line works too.
+// Input is read in large blocks and parsed in a single pass, so the
+// decoder runs at roughly the speed the file can be read.
+//
+// test/lcdtrace.cpp includes this file with LCDTRACE_NO_MAIN defined to
+// check the decoder against traces captured from the mocks.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+const size_t BLOCK_SIZE = 1 << 20;
+
+// Buffered output; printf() per instruction is far slower than the input.
+class Output {
+public:
+  Output() : _used(0) {}
+  ~Output() { flush(); }
+  void flush() {
+    fwrite(_buffer, 1, _used, stdout);
+    _used = 0;
+  }
+  void put(char c) {
+    if (_used == sizeof(_buffer)) {
+      flush();
+    }
+    _buffer[_used++] = c;
+  }
+  void puts(const char *s) {
+    while (*s) {
+      put(*s++);
+    }
+  }
+  void number(unsigned long long value, int width) {
+    char digits[24];
+    int n = 0;
+    do {
+      digits[n++] = '0' + value % 10;
+      value /= 10;
+    } while (value);
+    for (int i = n; i < width; ++i) {
+      put(' ');
+    }
+    while (n) {
+      put(digits[--n]);
+    }
+  }
+  void hex(unsigned value) {
+    static const char nibbles[] = "0123456789ABCDEF";
+    puts("0x");
+    put(nibbles[(value >> 4) & 0xF]);
+    put(nibbles[value & 0xF]);
+  }
+
+private:
+  char _buffer[1 << 16];
+  size_t _used;
+};
+
+// What the controller does with each byte it receives.
+class Controller {
+public:
+  Controller(Output &out, int cols, int rows, bool fourBit)
+      : _out(out), _cols(cols), _rows(rows), _fourBit(fourBit),
+        _twoLine(rows > 1), _haveHigh(false), _high(0), _firstWord(0),
+        _address(0), _shift(0), _increment(true), _shiftOnWrite(false),
+        _display(false), _cursor(false), _blink(false), _cgram(false),
+        _instructions(0), _writes(0) {
+    memset(_ddram, ' ', sizeof(_ddram));
+    memset(_cgramData, 0, sizeof(_cgramData));
+  }
+
+  // Returns true when the word completed an instruction or data transfer.
+  bool word(unsigned long long index, unsigned value, bool listing,
+            bool screen) {
+    bool rs = value & 0x200;
+    bool rw = value & 0x100;
+    uint8_t byte;
+    if (_fourBit) {
+      uint8_t nibble = (value >> 4) & 0x0F;
+      if (!_haveHigh) {
+        _haveHigh = true;
+        _high = nibble;
+        _firstWord = index;
+        return false;
+      }
+      _haveHigh = false;
+      byte = (_high << 4) | nibble;
+      index = _firstWord;
+    } else {
+      byte = value & 0xFF;
+    }
+
+    if (listing) {
+      _out.number(index, 12);
+      _out.puts(rs ? "  DR " : "  IR ");
+      _out.puts(rw ? "rd  " : "wr  ");
+      _out.hex(byte);
+      _out.puts("  ");
+    }
+    if (rw) {
+      if (listing) {
+        _out.puts(rs ? "read data\n" : "read busy flag / address\n");
+      }
+    } else if (rs) {
+      data(byte, listing);
+    } else {
+      instruction(byte, listing);
+    }
+    if (screen) {
+      show();
+    }
+    return true;
+  }
+
+  // the visible text of a row, NUL-terminated in text[cols + 1]
+  void line(int row, char *text) const {
+    for (int col = 0; col < _cols; ++col) {
+      uint8_t c = _ddram[visibleAddress(row, col)];
+      text[col] = c >= 0x20 && c < 0x7F ? (char)c : (c < 8 ? '0' + c : '.');
+    }
+    text[_cols] = '\0';
+  }
+
+  void show() {
+    char text[81];
+    for (int row = 0; row < _rows; ++row) {
+      line(row, text);
+      _out.puts("            |");
+      _out.puts(text);
+      _out.puts("|\n");
+    }
+    _out.puts("            display ");
+    _out.puts(_display ? "on" : "off");
+    _out.puts(", cursor ");
+    _out.puts(_cursor ? "on" : "off");
+    _out.puts(", blink ");
+    _out.puts(_blink ? "on" : "off");
+    _out.puts(", address ");
+    _out.hex(_address);
+    _out.puts(_cgram ? " (CGRAM)\n" : "\n");
+  }
+
+  unsigned long long instructions() const { return _instructions; }
+  unsigned long long writes() const { return _writes; }
+
+private:
+  Output &_out;
+  int _cols, _rows;
+  bool _fourBit, _twoLine, _haveHigh;
+  uint8_t _high;
+  unsigned long long _firstWord;
+  uint8_t _ddram[0x80];
+  uint8_t _cgramData[64];
+  uint8_t _address;
+  int _shift;
+  bool _increment, _shiftOnWrite, _display, _cursor, _blink, _cgram;
+  unsigned long long _instructions, _writes;
+
+  int lineLength() const { return _twoLine ? 40 : 80; }
+
+  // rows 2 and 3 continue rows 0 and 1, as LiquidCrystal's row offsets do
+  int visibleAddress(int row, int col) const {
+    int line = _twoLine ? (row & 1) : 0;
+    int start = (row >> 1) * _cols + (_twoLine ? 0 : (row & 1) * _cols);
+    int position = ((start + col + _shift) % lineLength() + lineLength()) %
+                   lineLength();
+    return line * 0x40 + position;
+  }
+
+  // after a read or write the address counter follows the entry mode
+  void step() { move(_increment ? 1 : -1); }
+
+  void move(int delta) {
+    if (_cgram) {
+      _address = (_address + delta) & 0x3F;
+      return;
+    }
+    int line = _twoLine ? (_address >> 6) : 0;
+    int position = _address & (_twoLine ? 0x3F : 0x7F);
+    position += delta;
+    if (position >= lineLength()) {
+      position = 0;
+      line ^= _twoLine;
+    } else if (position < 0) {
+      position = lineLength() - 1;
+      line ^= _twoLine;
+    }
+    _address = line * 0x40 + position;
+  }
+
+  void data(uint8_t byte, bool listing) {
+    ++_writes;
+    if (listing) {
+      _out.puts("write ");
+      if (byte >= 0x20 && byte < 0x7F) {
+        _out.put('\'');
+        _out.put(byte);
+        _out.put('\'');
+      } else {
+        _out.puts("char ");
+        _out.number(byte, 0);
+      }
+      _out.puts(_cgram ? " -> CGRAM " : " -> DDRAM ");
+      _out.hex(_address);
+      _out.put('\n');
+    }
+    if (_cgram) {
+      _cgramData[_address & 0x3F] = byte;
+    } else {
+      _ddram[_address & 0x7F] = byte;
+      if (_shiftOnWrite) {
+        _shift += _increment ? 1 : -1;
+      }
+    }
+    step();
+  }
+
+  void instruction(uint8_t byte, bool listing) {
+    ++_instructions;
+    if (byte & 0x80) {
+      _cgram = false;
+      _address = byte & 0x7F;
+      if (listing) {
+        _out.puts("set DDRAM address ");
+        _out.hex(_address);
+        _out.put('\n');
+      }
+    } else if (byte & 0x40) {
+      _cgram = true;
+      _address = byte & 0x3F;
+      if (listing) {
+        _out.puts("set CGRAM address ");
+        _out.hex(_address);
+        _out.puts(" (char ");
+        _out.number(_address >> 3, 0);
+        _out.puts(", row ");
+        _out.number(_address & 7, 0);
+        _out.puts(")\n");
+      }
+    } else if (byte & 0x20) {
+      _fourBit = !(byte & 0x10);
+      _twoLine = byte & 0x08;
+      if (listing) {
+        _out.puts("function set: ");
+        _out.puts(_fourBit ? "4-bit, " : "8-bit, ");
+        _out.puts(_twoLine ? "2 lines, " : "1 line, ");
+        _out.puts(byte & 0x04 ? "5x10\n" : "5x8\n");
+      }
+    } else if (byte & 0x10) {
+      bool display = byte & 0x08;
+      bool right = byte & 0x04;
+      if (display) {
+        _shift += right ? -1 : 1;
+      } else {
+        // R/L alone decides the direction, whatever the entry mode
+        move(right ? 1 : -1);
+      }
+      if (listing) {
+        _out.puts(display ? "shift display " : "move cursor ");
+        _out.puts(right ? "right\n" : "left\n");
+      }
+    } else if (byte & 0x08) {
+      _display = byte & 0x04;
+      _cursor = byte & 0x02;
+      _blink = byte & 0x01;
+      if (listing) {
+        _out.puts("display ");
+        _out.puts(_display ? "on" : "off");
+        _out.puts(", cursor ");
+        _out.puts(_cursor ? "on" : "off");
+        _out.puts(", blink ");
+        _out.puts(_blink ? "on\n" : "off\n");
+      }
+    } else if (byte & 0x04) {
+      _increment = byte & 0x02;
+      _shiftOnWrite = byte & 0x01;
+      if (listing) {
+        _out.puts("entry mode: ");
+        _out.puts(_increment ? "increment" : "decrement");
+        _out.puts(_shiftOnWrite ? ", shift display\n" : ", no shift\n");
+      }
+    } else if (byte & 0x02) {
+      _cgram = false;
+      _address = 0;
+      _shift = 0;
+      if (listing) {
+        _out.puts("return home\n");
+      }
+    } else if (byte & 0x01) {
+      memset(_ddram, ' ', sizeof(_ddram));
+      _cgram = false;
+      _address = 0;
+      _shift = 0;
+      _increment = true;
+      if (listing) {
+        _out.puts("clear display\n");
+      }
+    } else if (listing) {
+      _out.puts("(no operation)\n");
+    }
+  }
+};
+
+#ifndef LCDTRACE_NO_MAIN
+void usage() {
+  fprintf(stderr, "usage: lcdtrace [-b] [-4] [-c cols] [-r rows] [-s] [-q] "
+                  "[trace-file]\n");
+  exit(2);
+}
+#endif
+
+} // namespace
+
+#ifndef LCDTRACE_NO_MAIN
+int main(int argc, char **argv) {
+  bool binary = false, fourBit = false, screen = false, listing = true;
+  int cols = 16, rows = 2;
+  const char *path = NULL;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-b")) {
+      binary = true;
+    } else if (!strcmp(argv[i], "-4")) {
+      fourBit = true;
+    } else if (!strcmp(argv[i], "-s")) {
+      screen = true;
+    } else if (!strcmp(argv[i], "-q")) {
+      listing = false;
+    } else if (!strcmp(argv[i], "-c") && i + 1 < argc) {
+      cols = atoi(argv[++i]);
+    } else if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+      rows = atoi(argv[++i]);
+    } else if (argv[i][0] == '-' || path) {
+      usage();
+    } else {
+      path = argv[i];
+    }
+  }
+  if (cols < 1 || cols > 80 || rows < 1 || rows > 4) {
+    usage();
+  }
+
+  FILE *in = path ? fopen(path, "rb") : stdin;
+  if (!in) {
+    perror(path);
+    return 1;
+  }
+
+  Output out;
+  Controller lcd(out, cols, rows, fourBit);
+  unsigned char *block = (unsigned char *)malloc(BLOCK_SIZE);
+  unsigned long long index = 0;
+  unsigned value = 0;
+  bool inNumber = false, haveLowByte = false;
+  size_t got;
+  while ((got = fread(block, 1, BLOCK_SIZE, in)) > 0) {
+    for (size_t i = 0; i < got; ++i) {
+      unsigned char c = block[i];
+      if (binary) {
+        // a word may straddle two blocks
+        if (!haveLowByte) {
+          value = c;
+          haveLowByte = true;
+          continue;
+        }
+        haveLowByte = false;
+        lcd.word(index++, value | (c << 8), listing, screen);
+      } else if (c >= '0' && c <= '9') {
+        value = inNumber ? value * 10 + (c - '0') : (unsigned)(c - '0');
+        inNumber = true;
+      } else if (inNumber) {
+        inNumber = false;
+        lcd.word(index++, value, listing, screen);
+      }
+    }
+  }
+  if (inNumber) {
+    lcd.word(index++, value, listing, screen);
+  }
+  if (ferror(in)) {
+    perror(path ? path : "stdin");
+    return 1;
+  }
+  free(block);
+  if (in != stdin) {
+    fclose(in);
+  }
+
+  if (!screen) {
+    lcd.show();
+  }
+  out.flush();
+  fprintf(stderr, "%llu words, %llu instructions, %llu data writes\n", index,
+          lcd.instructions(), lcd.writes());
+  return 0;
+}
+#endif
@@ -0,0 +1,160 @@
+// lcdview: watch a LiquidCrystal_CI display live from another process.
+//
+// A test or simulation calls lcd.publishTo("/tmp/lcd.fb"); this viewer maps
+// the same file read-only and redraws the screen in the terminal whenever
+// the frame changes, at most RATE times a second. Reading never blocks the
+// simulation (see LCDFramebuffer.h), so the viewer can poll as often as it
+// likes. The viewer may be started before the simulation.
+//
+// Build:  c++ -O2 -std=c++11 -I../.. -o lcdview lcdview.cpp -pthread
+// Usage:  lcdview [options] framebuffer-file
+//
+//   -r RATE       redraws per second at most (default 30)
+//   -1            print the current frame once and exit
+//
+// Custom characters show as their slot number in reverse video, and the
+// cursor cell is underlined when the cursor or blink is on.
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "LCDFramebuffer.h"
+
+namespace {
+
+void drawCell(const LCDFrame &frame, int col, int row) {
+  uint8_t c = frame.grid[row][col];
+  bool cursor = (frame.flags & (LCD_FRAME_CURSOR | LCD_FRAME_BLINK)) &&
+                frame.cursorCol == col && frame.cursorRow == row;
+  if (cursor) {
+    fputs("\x1b[4m", stdout);
+  }
+  if (c < 16) {
+    printf("\x1b[7m%d\x1b[27m", c & 7);
+  } else if (c < 0x20 || c > 0x7E) {
+    putchar('.');
+  } else {
+    putchar(c);
+  }
+  if (cursor) {
+    fputs("\x1b[24m", stdout);
+  }
+}
+
+void draw(const LCDFrame &frame, bool clear) {
+  if (clear) {
+    fputs("\x1b[H\x1b[J", stdout);
+  }
+  unsigned long long us = frame.micros;
+  printf("rs %d  %dx%d  [%llu:%02llu:%02llu.%06llu]  %u updates\n",
+         frame.rsPin, frame.cols, frame.rows, us / 3600000000ULL,
+         us / 60000000ULL % 60, us / 1000000ULL % 60, us % 1000000ULL,
+         frame.updates);
+  printf("+");
+  for (int col = 0; col < frame.cols; ++col) {
+    putchar('-');
+  }
+  printf("+\n");
+  for (int row = 0; row < frame.rows && row < 4; ++row) {
+    putchar('|');
+    if (!(frame.flags & LCD_FRAME_DISPLAY)) {
+      fputs("\x1b[2m", stdout);
+    }
+    // through the shifted window
+    for (int col = 0; col < frame.cols && col < 40; ++col) {
+      drawCell(frame, (col + frame.shift) % 40, row);
+    }
+    fputs("\x1b[22m|\n", stdout);
+  }
+  printf("+");
+  for (int col = 0; col < frame.cols; ++col) {
+    putchar('-');
+  }
+  printf("+\ncursor %d,%d%s%s%s%s\n", frame.cursorCol, frame.cursorRow,
+         frame.flags & LCD_FRAME_DISPLAY ? "" : "  display off",
+         frame.flags & LCD_FRAME_CURSOR ? "  cursor" : "",
+         frame.flags & LCD_FRAME_BLINK ? "  blink" : "",
+         frame.flags & LCD_FRAME_AUTOSCROLL ? "  autoscroll" : "");
+  fflush(stdout);
+}
+
+// Maps the file once the simulation has created it.
+const LCDFramebuffer *map(const char *path, bool wait) {
+  for (;;) {
+    int fd = open(path, O_RDONLY);
+    struct stat st;
+    if (fd >= 0 && fstat(fd, &st) == 0 &&
+        st.st_size >= (off_t)sizeof(LCDFramebuffer)) {
+      void *mapped =
+          mmap(nullptr, sizeof(LCDFramebuffer), PROT_READ, MAP_SHARED, fd, 0);
+      close(fd);
+      if (mapped == MAP_FAILED) {
+        perror(path);
+        return nullptr;
+      }
+      return (const LCDFramebuffer *)mapped;
+    }
+    if (fd >= 0) {
+      close(fd);
+    }
+    if (!wait) {
+      fprintf(stderr, "%s: not a framebuffer\n", path);
+      return nullptr;
+    }
+    usleep(100000);
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  double rate = 30;
+  bool once = false;
+  const char *path = nullptr;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+      rate = atof(argv[++i]);
+    } else if (!strcmp(argv[i], "-1")) {
+      once = true;
+    } else if (argv[i][0] != '-' && !path) {
+      path = argv[i];
+    } else {
+      path = nullptr;
+      break;
+    }
+  }
+  if (!path || rate <= 0) {
+    fprintf(stderr, "usage: %s [-r rate] [-1] framebuffer-file\n", argv[0]);
+    return 2;
+  }
+
+  const LCDFramebuffer *framebuffer = map(path, !once);
+  if (!framebuffer) {
+    return 1;
+  }
+  while (!framebuffer->isValid()) {
+    if (once) {
+      fprintf(stderr, "%s: not a framebuffer\n", path);
+      return 1;
+    }
+    usleep(100000);
+  }
+
+  LCDFrame frame;
+  uint32_t shown = framebuffer->read(&frame);
+  draw(frame, !once);
+  while (!once) {
+    usleep((useconds_t)(1000000 / rate));
+    uint32_t sequence = framebuffer->read(&frame);
+    if (sequence != shown) {
+      shown = sequence;
+      draw(frame, true);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,29 @@
+// A title centered on the first row and a right-aligned counter on the last,
+// which should hold on every geometry.
+#include "matrix.h"
+
+String scenario(LiquidCrystal_CI &lcd, const MatrixCase &c) {
+  const char title[] = "Setup";
+  int titleCol = (c.cols - (int)strlen(title)) / 2;
+  lcd.clear();
+  lcd.setCursor(titleCol, 0);
+  lcd.print(title);
+  for (int count = 0; count < 100; ++count) {
+    String value(count);
+    lcd.setCursor(c.cols - value.length(), c.rows - 1);
+    lcd.print(value);
+  }
+
+  std::vector<String> lines = lcd.getLines();
+  if (lines.size() != c.rows) {
+    return "expected " + String(c.rows) + " lines, got " + String(lines.size());
+  }
+  if (lines.at(0).indexOf(title) != titleCol) {
+    return "title not centered: '" + lines.at(0) + "'";
+  }
+  if (!lines.at(c.rows - 1).endsWith("99") ||
+      (int)lines.at(c.rows - 1).length() != c.cols) {
+    return "counter not right-aligned: '" + lines.at(c.rows - 1) + "'";
+  }
+  return "";
+}
@@ -0,0 +1,18 @@
+#pragma once
+// Interface between matrix_runner.cpp and a screen scenario. A scenario file
+// includes this header and defines scenario(); run_matrix.sh links it with
+// the runner, which calls it once per geometry and wiring, each time in a
+// freshly forked process.
+
+#include "LiquidCrystal_CI.h"
+
+struct MatrixCase {
+  uint8_t cols;
+  uint8_t rows;
+  bool eightBit;
+  bool rw;
+};
+
+// Drives lcd, which has already been begun with c.cols x c.rows, and checks
+// the result. Returns an empty String on success, otherwise what went wrong.
+String scenario(LiquidCrystal_CI &lcd, const MatrixCase &c);
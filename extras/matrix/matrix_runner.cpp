@@ -0,0 +1,277 @@
+// Geometry and wiring matrix runner: runs one screen scenario (see matrix.h)
+// on every geometry begin() supports, with 4-bit and 8-bit wiring, with and
+// without rw. Each combination runs in its own forked worker, because the
+// arduino_ci mocks keep their state in process-wide globals, and up to one
+// worker per core runs at a time. Build and run it with run_matrix.sh next
+// to this file.
+//
+// Options:
+//   -j JOBS      concurrent workers (default: online cores)
+//   -g COLSxROWS only this geometry; may be repeated
+//   -v           print each combination's final screen
+//
+// The report lists pass/fail and the scenario's bus cost for each
+// combination (enable pulses and virtual microseconds, not counting the
+// constructor and begin()), followed by totals. Exit status is 1 if any
+// combination failed or its worker crashed.
+
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "matrix.h"
+
+namespace {
+
+const uint8_t rs = 1;
+const uint8_t rw = 2;
+const uint8_t enable = 3;
+const uint8_t d[8] = {10, 11, 12, 13, 14, 15, 16, 17};
+
+// character LCD modules built on the HD44780 and its clones; 40x4 needs a
+// second enable line, which LiquidCrystal doesn't drive
+const uint8_t geometries[][2] = {{8, 1},  {8, 2},  {16, 1}, {16, 2},
+                                 {16, 4}, {20, 1}, {20, 2}, {20, 4},
+                                 {24, 1}, {24, 2}, {40, 1}, {40, 2}};
+
+// written by a worker in one write(), so records from different workers
+// never interleave on the shared pipe
+struct Result {
+  int index;
+  bool passed;
+  unsigned long pulses;
+  unsigned long micros;
+  char message[200];
+  char screen[4 * 41 + 1];
+};
+
+class PulseCounter : public DataStreamObserver {
+public:
+  unsigned long pulses;
+
+  PulseCounter() : DataStreamObserver(false, false), pulses(0) {
+    GODMODE()->digitalPin[enable].addObserver("matrix", this);
+  }
+
+  ~PulseCounter() { GODMODE()->digitalPin[enable].removeObserver("matrix"); }
+
+  virtual void onBit(bool aBit) {
+    if (aBit) {
+      ++pulses;
+    }
+  }
+
+  virtual String observerName() const { return "PulseCounter"; }
+};
+
+LiquidCrystal_CI *create(const MatrixCase &c) {
+  if (c.eightBit && c.rw) {
+    return new LiquidCrystal_CI(rs, rw, enable, d[0], d[1], d[2], d[3], d[4],
+                                d[5], d[6], d[7]);
+  }
+  if (c.eightBit) {
+    return new LiquidCrystal_CI(rs, enable, d[0], d[1], d[2], d[3], d[4],
+                                d[5], d[6], d[7]);
+  }
+  if (c.rw) {
+    return new LiquidCrystal_CI(rs, rw, enable, d[4], d[5], d[6], d[7]);
+  }
+  return new LiquidCrystal_CI(rs, enable, d[4], d[5], d[6], d[7]);
+}
+
+void copy(char *to, size_t size, const String &from) {
+  strncpy(to, from.c_str(), size - 1);
+  to[size - 1] = '\0';
+}
+
+// runs in the worker
+Result runCase(int index, const MatrixCase &c) {
+  Result result;
+  memset(&result, 0, sizeof(result));
+  result.index = index;
+
+  LiquidCrystal_CI *lcd = create(c);
+  lcd->begin(c.cols, c.rows);
+  PulseCounter counter;
+  unsigned long start = GODMODE()->micros;
+  String message = scenario(*lcd, c);
+  result.pulses = counter.pulses;
+  result.micros = GODMODE()->micros - start;
+  result.passed = message.length() == 0;
+  copy(result.message, sizeof(result.message), message);
+
+  String screen;
+  std::vector<String> lines = lcd->getLines();
+  for (size_t row = 0; row < lines.size() && row < 4; ++row) {
+    screen += lines.at(row) + "\n";
+  }
+  copy(result.screen, sizeof(result.screen), screen);
+  delete lcd;
+  return result;
+}
+
+void writeAll(int fd, const void *data, size_t size) {
+  const char *p = (const char *)data;
+  while (size) {
+    ssize_t n = write(fd, p, size);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      _exit(3);
+    }
+    p += n;
+    size -= n;
+  }
+}
+
+// reads whatever records the workers have written so far
+void drain(int fd, std::vector<Result> &results, std::vector<bool> &reported) {
+  Result result;
+  while (read(fd, &result, sizeof(result)) == sizeof(result)) {
+    results[result.index] = result;
+    reported[result.index] = true;
+  }
+}
+
+void describe(char *out, size_t size, const MatrixCase &c) {
+  snprintf(out, size, "%2dx%d %s %s", c.cols, c.rows,
+           c.eightBit ? "8-bit" : "4-bit", c.rw ? "rw   " : "no-rw");
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  long jobs = sysconf(_SC_NPROCESSORS_ONLN);
+  bool verbose = false;
+  std::vector<int> only;
+  for (int i = 1; i < argc; ++i) {
+    int cols, rows;
+    if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+      jobs = atol(argv[++i]);
+    } else if (!strcmp(argv[i], "-g") && i + 1 < argc &&
+               sscanf(argv[++i], "%dx%d", &cols, &rows) == 2) {
+      only.push_back(cols * 256 + rows);
+    } else if (!strcmp(argv[i], "-v")) {
+      verbose = true;
+    } else {
+      fprintf(stderr, "usage: %s [-j jobs] [-g COLSxROWS]... [-v]\n",
+              argv[0]);
+      return 2;
+    }
+  }
+  if (jobs < 1) {
+    jobs = 1;
+  }
+
+  std::vector<MatrixCase> cases;
+  for (size_t g = 0; g < sizeof(geometries) / sizeof(geometries[0]); ++g) {
+    int key = geometries[g][0] * 256 + geometries[g][1];
+    if (!only.empty() &&
+        std::find(only.begin(), only.end(), key) == only.end()) {
+      continue;
+    }
+    for (int wiring = 0; wiring < 4; ++wiring) {
+      MatrixCase c = {geometries[g][0], geometries[g][1], wiring >= 2,
+                      (wiring & 1) != 0};
+      cases.push_back(c);
+    }
+  }
+  if (cases.empty()) {
+    fprintf(stderr, "no such geometry\n");
+    return 2;
+  }
+
+  // drained after every exit, so it holds at most one record per worker
+  int fds[2];
+  if (pipe(fds) || fcntl(fds[0], F_SETFL, O_NONBLOCK)) {
+    perror("pipe");
+    return 1;
+  }
+  std::vector<Result> results(cases.size());
+  std::vector<bool> reported(cases.size(), false);
+  std::vector<pid_t> pids(cases.size(), 0);
+  std::vector<int> statuses(cases.size(), 0);
+  size_t next = 0, running = 0, finished = 0;
+
+  fflush(stdout);
+  while (finished < cases.size()) {
+    while (running < (size_t)jobs && next < cases.size()) {
+      pid_t pid = fork();
+      if (pid < 0) {
+        perror("fork");
+        if (running == 0) {
+          return 1;
+        }
+        break;
+      }
+      if (pid == 0) {
+        close(fds[0]);
+        Result result = runCase(next, cases[next]);
+        writeAll(fds[1], &result, sizeof(result));
+        fflush(stdout);
+        _exit(0);
+      }
+      pids[next++] = pid;
+      ++running;
+    }
+
+    int status;
+    pid_t pid = waitpid(-1, &status, 0);
+    if (pid < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      perror("waitpid");
+      return 1;
+    }
+    for (size_t i = 0; i < next; ++i) {
+      if (pids[i] == pid) {
+        statuses[i] = status;
+        --running;
+        ++finished;
+      }
+    }
+    drain(fds[0], results, reported);
+  }
+  close(fds[1]);
+  close(fds[0]);
+
+  int failures = 0;
+  unsigned long long pulses = 0, micros = 0;
+  for (size_t i = 0; i < cases.size(); ++i) {
+    char name[32];
+    describe(name, sizeof(name), cases[i]);
+    if (!reported[i]) {
+      ++failures;
+      if (WIFSIGNALED(statuses[i])) {
+        printf("%s  CRASH  signal %d\n", name, WTERMSIG(statuses[i]));
+      } else {
+        printf("%s  CRASH  exit %d\n", name, WEXITSTATUS(statuses[i]));
+      }
+      continue;
+    }
+    const Result &r = results[i];
+    pulses += r.pulses;
+    micros += r.micros;
+    printf("%s  %s  %8lu pulses %10lu us%s%s\n", name,
+           r.passed ? "pass " : "FAIL ", r.pulses, r.micros,
+           r.passed ? "" : "  ", r.message);
+    if (!r.passed) {
+      ++failures;
+    }
+    if (verbose) {
+      printf("%s", r.screen);
+    }
+  }
+  printf("%d of %d combinations passed; %llu pulses, %.3f virtual seconds\n",
+         (int)cases.size() - failures, (int)cases.size(), pulses,
+         micros / 1e6);
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,24 @@
+#!/bin/sh
+# Build a screen scenario against LiquidCrystal_CI and the arduino_ci mocks,
+# then run it across the geometry and wiring matrix with matrix_runner.cpp.
+#
+#   extras/matrix/run_matrix.sh extras/matrix/example_scenario.cpp -j 8
+#
+# ARDUINO_CI defaults to the arduino_ci gem from the Gemfile (bundle install
+# first); LIQUIDCRYSTAL defaults to where arduino_ci installs dependencies.
+set -e
+[ $# -ge 1 ] || { echo "usage: $0 scenario.cpp [runner options]" >&2; exit 2; }
+SCENARIO=$1
+shift
+LIB=$(cd "$(dirname "$0")/../.." && pwd)
+ARDUINO_CI=${ARDUINO_CI:-$(cd "$LIB" && bundle show arduino_ci)}
+LIQUIDCRYSTAL=${LIQUIDCRYSTAL:-$HOME/Arduino/libraries/LiquidCrystal/src}
+OUT=${OUT:-${TMPDIR:-/tmp}/$(basename "$SCENARIO" .cpp)_matrix}
+
+${CXX:-c++} -std=c++11 -O2 -DARDUINO=100 -DARDUINO_CI_COMPILATION_MOCKS \
+  -I"$ARDUINO_CI/cpp/arduino" -I"$LIQUIDCRYSTAL" -I"$LIB" \
+  -I"$LIB/extras/matrix" "$SCENARIO" \
+  "$LIB/extras/matrix/matrix_runner.cpp" "$LIB"/*.cpp \
+  "$LIQUIDCRYSTAL"/*.cpp "$ARDUINO_CI"/cpp/arduino/*.cpp \
+  -pthread -o "$OUT"
+exec "$OUT" "$@"
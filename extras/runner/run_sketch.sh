@@ -0,0 +1,24 @@
+#!/bin/sh
+# Build a sketch against LiquidCrystal_CI and the arduino_ci mocks, then run
+# it headless with sketch_runner.cpp.
+#
+#   extras/runner/run_sketch.sh examples/LiquidCrystal_CI.ino -d 3600
+#
+# ARDUINO_CI defaults to the arduino_ci gem from the Gemfile (bundle install
+# first); LIQUIDCRYSTAL defaults to where arduino_ci installs dependencies.
+set -e
+[ $# -ge 1 ] || { echo "usage: $0 sketch.ino [runner options]" >&2; exit 2; }
+SKETCH=$1
+shift
+LIB=$(cd "$(dirname "$0")/../.." && pwd)
+ARDUINO_CI=${ARDUINO_CI:-$(cd "$LIB" && bundle show arduino_ci)}
+LIQUIDCRYSTAL=${LIQUIDCRYSTAL:-$HOME/Arduino/libraries/LiquidCrystal/src}
+OUT=${OUT:-${TMPDIR:-/tmp}/$(basename "$SKETCH" .ino)_runner}
+
+${CXX:-c++} -std=c++11 -O2 -DARDUINO=100 -DARDUINO_CI_COMPILATION_MOCKS \
+  -I"$ARDUINO_CI/cpp/arduino" -I"$LIQUIDCRYSTAL" -I"$LIB" \
+  -x c++ -include Arduino.h "$SKETCH" -x none \
+  "$LIB/extras/runner/sketch_runner.cpp" "$LIB"/*.cpp \
+  "$LIQUIDCRYSTAL"/*.cpp "$ARDUINO_CI"/cpp/arduino/*.cpp \
+  -pthread -o "$OUT"
+exec "$OUT" "$@"
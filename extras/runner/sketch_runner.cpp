@@ -0,0 +1,91 @@
+// Headless sketch runner: links a sketch against LiquidCrystal_CI and the
+// arduino_ci mocks, calls setup() and then loop() as fast as the host
+// allows, and prints every distinct screen frame with its virtual time.
+// Build and run it with run_sketch.sh next to this file.
+//
+// Options:
+//   -d SECONDS   virtual time to simulate (default 60)
+//   -t MICROS    virtual time added after a loop() that didn't advance
+//                the clock itself, e.g. one that only polls (default 1000)
+//
+// Frames are compared after setup() and after each loop(), for every
+// LiquidCrystal_CI registered through forRsPin().
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Arduino.h"
+#include "LiquidCrystal_CI.h"
+
+void setup();
+void loop();
+
+namespace {
+
+String frames[MOCK_PINS_COUNT];
+
+String frameOf(LiquidCrystal_CI *lcd) {
+  String frame;
+  std::vector<String> lines = lcd->getLines();
+  for (size_t row = 0; row < lines.size(); ++row) {
+    String line = lines.at(row);
+    while ((int)line.length() < lcd->getCols()) {
+      line += ' ';
+    }
+    frame += "  |" + line + "|\n";
+  }
+  return frame;
+}
+
+void printChangedFrames() {
+  unsigned long now = micros();
+  for (int rs = 0; rs < MOCK_PINS_COUNT; ++rs) {
+    LiquidCrystal_CI *lcd = LiquidCrystal_CI::forRsPin(rs);
+    if (!lcd) {
+      continue;
+    }
+    String frame = frameOf(lcd);
+    if (frame != frames[rs]) {
+      frames[rs] = frame;
+      printf("[%lu:%02lu:%02lu.%06lu] rs %d\n%s", now / 3600000000UL,
+             now / 60000000UL % 60, now / 1000000UL % 60, now % 1000000UL, rs,
+             frame.c_str());
+    }
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  double seconds = 60;
+  unsigned long tick = 1000;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "-d") && i + 1 < argc) {
+      seconds = atof(argv[++i]);
+    } else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+      tick = strtoul(argv[++i], NULL, 10);
+    } else {
+      fprintf(stderr, "usage: %s [-d seconds] [-t idle-micros]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  GodmodeState *state = GODMODE();
+  unsigned long end = state->micros + (unsigned long)(seconds * 1000000);
+  unsigned long loops = 0;
+  setup();
+  printChangedFrames();
+  while (state->micros < end) {
+    unsigned long before = state->micros;
+    loop();
+    ++loops;
+    if (state->micros == before) {
+      state->micros += tick;
+    }
+    printChangedFrames();
+  }
+  fprintf(stderr, "%lu loops, %.3f virtual seconds\n", loops,
+          state->micros / 1e6);
+  return 0;
+}
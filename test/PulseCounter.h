@@ -0,0 +1,36 @@
+#pragma once
+// Shared by the tests that count bus traffic: the pins they wire the
+// display to, and an observer that counts enable pulses.
+#include "ArduinoUnitTests.h"
+#include "ci/ObservableDataStream.h"
+
+const byte rs = 1;
+const byte enable = 3;
+const byte d4 = 14;
+const byte d5 = 15;
+const byte d6 = 16;
+const byte d7 = 17;
+
+// enable pulses; in 4-bit mode each byte sent is two
+class PulseCounter : public DataStreamObserver {
+private:
+  GodmodeState *state;
+
+public:
+  unsigned long pulses;
+
+  PulseCounter() : DataStreamObserver(false, false), pulses(0) {
+    state = GODMODE();
+    state->digitalPin[enable].addObserver("lcd", this);
+  }
+
+  ~PulseCounter() { state->digitalPin[enable].removeObserver("lcd"); }
+
+  virtual void onBit(bool aBit) {
+    if (aBit) {
+      ++pulses;
+    }
+  }
+
+  virtual String observerName() const { return "PulseCounter"; }
+};
@@ -0,0 +1,110 @@
+#include "ArduinoUnitTests.h"
+
+#include "LiquidCrystal_CI.h"
+#include "LiquidCrystal_CI_C.h"
+
+const byte rs = 1;
+const byte rw = 2;
+const byte enable = 3;
+const byte d4 = 14;
+const byte d5 = 15;
+const byte d6 = 16;
+const byte d7 = 17;
+
+String line(const lcd_ci_snapshot &snapshot, int row, int cols) {
+  return String(std::string((const char *)snapshot.lines[row], cols));
+}
+
+unittest(batch_matches_native_calls) {
+  lcd_ci *handle = lcd_ci_create(rs, enable, d4, d5, d6, d7);
+  const uint8_t ops[] = {
+      LCD_CI_OP_BEGIN, 16, 2,
+      LCD_CI_OP_DISPLAY,
+      LCD_CI_OP_SET_CURSOR, 2, 1,
+      LCD_CI_OP_PRINT, 5, 'H', 'e', 'l', 'l', 'o',
+      LCD_CI_OP_CREATE_CHAR, 3, 1, 2, 3, 4, 5, 6, 7, 8,
+      LCD_CI_OP_CURSOR,
+      LCD_CI_OP_SNAPSHOT,
+      LCD_CI_OP_CLEAR,
+      LCD_CI_OP_SET_CURSOR, 0, 0,
+      LCD_CI_OP_WRITE, 'x',
+      LCD_CI_OP_SCROLL_LEFT,
+      LCD_CI_OP_SNAPSHOT,
+  };
+  lcd_ci_snapshot snapshots[2];
+  assertEqual(2, lcd_ci_run(handle, ops, sizeof(ops), snapshots, 2));
+
+  assertEqual(16, snapshots[0].cols);
+  assertEqual(2, snapshots[0].rows);
+  assertEqual("                ", line(snapshots[0], 0, 16));
+  assertEqual("  Hello         ", line(snapshots[0], 1, 16));
+  assertEqual(LCD_CI_DISPLAY | LCD_CI_CURSOR, snapshots[0].flags);
+  assertEqual(8, snapshots[0].cgram[3][7]);
+  assertEqual("x", line(snapshots[1], 0, 1));
+  assertEqual("  ", line(snapshots[1], 1, 2));
+  assertEqual(1, snapshots[1].cursor_col);
+  assertEqual(0, snapshots[1].cursor_row);
+  assertEqual(1, snapshots[1].shift);
+
+  // the same calls made directly leave the same shadow
+  LiquidCrystal_CI lcd(rw, enable, d4, d5, d6, d7);
+  byte charmap[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  lcd.begin(16, 2);
+  lcd.display();
+  lcd.setCursor(2, 1);
+  lcd.print("Hello");
+  lcd.createChar(3, charmap);
+  lcd.cursor();
+  lcd.clear();
+  lcd.setCursor(0, 0);
+  lcd.write('x');
+  lcd.scrollDisplayLeft();
+  LCDFrame frame;
+  lcd.getFrame(&frame);
+  lcd_ci_snapshot now;
+  lcd_ci_snapshot_of(handle, &now);
+  assertEqual(0, memcmp(frame.grid, now.lines, sizeof(now.lines)));
+  assertEqual(0, memcmp(frame.cgram, now.cgram, sizeof(now.cgram)));
+  assertEqual(frame.flags, now.flags);
+  assertEqual(frame.cursorCol, now.cursor_col);
+  assertEqual(frame.shift, now.shift);
+
+  lcd_ci_destroy(handle);
+}
+
+unittest(bad_buffers_stop_at_the_offending_operation) {
+  lcd_ci *handle = lcd_ci_create(rs, enable, d4, d5, d6, d7);
+  lcd_ci_snapshot snapshot;
+  const uint8_t begin[] = {LCD_CI_OP_BEGIN, 16, 2};
+  assertEqual(0, lcd_ci_run(handle, begin, sizeof(begin), nullptr, 0));
+
+  // the write at offset 0 runs, the unknown operation at 2 doesn't
+  const uint8_t unknown[] = {LCD_CI_OP_WRITE, 'a', 0xFF, LCD_CI_OP_HOME};
+  assertEqual(-3, lcd_ci_run(handle, unknown, sizeof(unknown), nullptr, 0));
+  LiquidCrystal_CI *lcd = LiquidCrystal_CI::forRsPin(rs);
+  assertEqual("a", lcd->getLines().at(0));
+  assertEqual(1, lcd->getCursorCol());
+
+  // a print longer than the buffer
+  const uint8_t truncated[] = {LCD_CI_OP_HOME, LCD_CI_OP_PRINT, 4, 'a', 'b'};
+  assertEqual(-2,
+              lcd_ci_run(handle, truncated, sizeof(truncated), nullptr, 0));
+  const uint8_t cut[] = {LCD_CI_OP_SET_CURSOR, 1};
+  assertEqual(-1, lcd_ci_run(handle, cut, sizeof(cut), nullptr, 0));
+  assertEqual(0, lcd->getCursorCol());
+
+  // one snapshot more than there is room for
+  const uint8_t two[] = {LCD_CI_OP_SNAPSHOT, LCD_CI_OP_SNAPSHOT};
+  assertEqual(-2, lcd_ci_run(handle, two, sizeof(two), &snapshot, 1));
+
+  // delays move the mock clock
+  const uint8_t wait[] = {LCD_CI_OP_DELAY, 0x40, 0x42, 0x0F, 0,
+                          LCD_CI_OP_SNAPSHOT};
+  unsigned long start = micros();
+  assertEqual(1, lcd_ci_run(handle, wait, sizeof(wait), &snapshot, 1));
+  assertEqual(start + 1000000, snapshot.micros);
+
+  lcd_ci_destroy(handle);
+}
+
+unittest_main()
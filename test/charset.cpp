@@ -0,0 +1,86 @@
+#include "ArduinoUnitTests.h"
+
+#include "LCDCharset.h"
+#include "LiquidCrystal_CI.h"
+
+const byte rs = 1;
+const byte enable = 3;
+const byte d4 = 14;
+const byte d5 = 15;
+const byte d6 = 16;
+const byte d7 = 17;
+
+unittest(utf8_to_a00) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LCDCharsetPrint<LCD_ROM_A00> text(lcd);
+  // one byte consumed per input byte, one ROM code per character
+  assertEqual(strlen("21°C µs ÷"), text.print("21°C µs ÷"));
+  String line = lcd.getLines().at(0);
+  assertEqual(9, line.length());
+  assertEqual(0xDF, (uint8_t)line[2]);
+  assertEqual(0xE4, (uint8_t)line[5]);
+  assertEqual(0xFD, (uint8_t)line[8]);
+
+  lcd.setCursor(0, 1);
+  // full-width and half-width katakana land on the same codes, accents
+  // that A00 lacks are dropped, and backslash has no glyph
+  text.print("カｶé¥\\");
+  line = lcd.getLines().at(1);
+  assertEqual(5, line.length());
+  assertEqual(0xB6, (uint8_t)line[0]);
+  assertEqual(0xB6, (uint8_t)line[1]);
+  assertEqual('e', line[2]);
+  assertEqual(0x5C, (uint8_t)line[3]);
+  assertEqual('?', line[4]);
+}
+
+unittest(utf8_to_a02) {
+  assertEqual(0xE9, LCDCharset<LCD_ROM_A02>::toRom(0xE9)); // é
+  assertEqual(0x82, LCDCharset<LCD_ROM_A02>::toRom(0x416)); // Ж
+  assertEqual(0xB5, LCDCharset<LCD_ROM_A02>::toRom(0x3BC)); // μ
+  assertEqual(0x10, LCDCharset<LCD_ROM_A02>::toRom(0x10));
+  assertEqual(-1, LCDCharset<LCD_ROM_A00>::toRom(0x416));
+  assertEqual(-1, LCDCharset<LCD_ROM_A02>::toRom(0x1F600));
+  assertEqual(0, LCDCharset<LCD_ROM_A02>::toRom(0x24EA)); // ⓪
+  assertEqual(7, LCDCharset<LCD_ROM_A02>::toRom(0x2466)); // ⑦
+}
+
+unittest(malformed_utf8) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LCDCharsetPrint<LCD_ROM_A02> text(lcd, '#');
+  // a lone continuation byte, a truncated sequence, then valid text
+  const uint8_t bytes[] = {'a', 0x80, 0xC3, 'b', 0xC3, 0xA9};
+  text.write(bytes, sizeof(bytes));
+  assertEqual("a##b\xE9", lcd.getLines().at(0));
+}
+
+unittest(shadow_as_utf8) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LCDCharsetPrint<LCD_ROM_A02> text(lcd);
+  text.print("Größe ≤ 5");
+  lcd.setCursor(0, 1);
+  lcd.write(byte(0));
+  lcd.write(byte(9));
+  lcd.print("\xFF");
+
+  std::vector<String> lines = lcd.getLinesUTF8(LCD_ROM_A02);
+  assertEqual("Größe ≤ 5", lines.at(0));
+  assertEqual("⓪①ÿ", lines.at(1));
+  lines = lcd.getLinesUTF8(LCD_ROM_A00);
+  assertEqual("⓪①█", lines.at(1));
+
+  // every ROM code that has a glyph reads back as itself
+  for (int code = 0x20; code < 0x100; ++code) {
+    char utf8[6];
+    LCDCharset<LCD_ROM_A02>::toUTF8(code, utf8);
+    LiquidCrystal_CI round(rs, enable, d4, d5, d6, d7);
+    round.begin(16, 1);
+    LCDCharsetPrint<LCD_ROM_A02>(round).print(utf8);
+    assertEqual(code, (uint8_t)round.getLines().at(0)[0]);
+  }
+}
+
+unittest_main()
@@ -0,0 +1,134 @@
+#include "ArduinoUnitTests.h"
+#include "PulseCounter.h"
+
+#include "LCDWriteCombiner.h"
+
+unittest(calls_that_change_nothing_are_dropped) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  LCDWriteCombiner screen(lcd);
+  screen.begin(16, 2);
+  PulseCounter counter;
+
+  screen.setCursor(0, 0);
+  screen.home();
+  screen.display();
+  screen.noCursor();
+  screen.noBlink();
+  screen.leftToRight();
+  screen.noAutoscroll();
+  assertEqual(0, counter.pulses);
+  assertEqual(7, screen.getElided());
+
+  screen.blink();
+  assertEqual(2, counter.pulses);
+  screen.blink();
+  assertEqual(2, counter.pulses);
+}
+
+unittest(cursor_moves_wait_for_the_next_write) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  LCDWriteCombiner screen(lcd);
+  screen.begin(16, 2);
+  PulseCounter counter;
+
+  screen.setCursor(3, 1);
+  screen.setCursor(5, 0);
+  screen.setCursor(2, 1);
+  assertEqual(0, counter.pulses);
+  screen.print("ab");
+  // one setCursor and two characters
+  assertEqual(2 * 3, counter.pulses);
+  assertEqual(2, screen.getElided());
+
+  // already there after printing
+  counter.pulses = 0;
+  screen.setCursor(4, 1);
+  screen.print("c");
+  assertEqual(2, counter.pulses);
+  assertEqual("  abc", lcd.getLines().at(1).substring(0, 5));
+}
+
+unittest(address_follows_the_line_wrap) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  LCDWriteCombiner screen(lcd);
+  screen.begin(16, 2);
+  screen.setCursor(39, 0);
+  screen.print("x");
+  PulseCounter counter;
+  // 0x27 is followed by 0x40, the start of the second line
+  screen.setCursor(0, 1);
+  screen.print("y");
+  assertEqual(2, counter.pulses);
+
+  // 4 x 20: the third line continues the first
+  LiquidCrystal_CI wide(rs, enable, d4, d5, d6, d7);
+  LCDWriteCombiner four(wide);
+  four.begin(20, 4);
+  four.setCursor(19, 0);
+  four.print("a");
+  counter.pulses = 0;
+  four.setCursor(0, 2);
+  four.print("b");
+  assertEqual(2, counter.pulses);
+
+  // right to left counts down
+  screen.rightToLeft();
+  screen.setCursor(8, 0);
+  screen.print("ab");
+  counter.pulses = 0;
+  screen.setCursor(6, 0);
+  screen.print("c");
+  assertEqual(2, counter.pulses);
+}
+
+unittest(visible_cursor_moves_at_once) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  LCDWriteCombiner screen(lcd);
+  screen.begin(16, 2);
+  screen.cursor();
+  PulseCounter counter;
+  screen.setCursor(4, 1);
+  assertEqual(2, counter.pulses);
+
+  // nothing is known before begin()
+  LiquidCrystal_CI other(rs, enable, d4, d5, d6, d7);
+  other.begin(16, 2);
+  LCDWriteCombiner fresh(other);
+  counter.pulses = 0;
+  fresh.display();
+  fresh.setCursor(0, 0);
+  assertEqual(4, counter.pulses);
+}
+
+unittest(custom_characters_lose_the_address) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  LCDWriteCombiner screen(lcd);
+  screen.begin(16, 2);
+  uint8_t bitmap[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+  screen.createChar(0, bitmap);
+  PulseCounter counter;
+  screen.setCursor(0, 0);
+  screen.write((uint8_t)0);
+  assertEqual(2 * 2, counter.pulses);
+  assertEqual('\0', lcd.getLines().at(0)[0]);
+
+  // rewriting through the combiner shows the same as writing directly
+  LiquidCrystal_CI direct(rs, enable, d4, d5, d6, d7);
+  direct.begin(16, 2);
+  screen.clear();
+  screen.setCursor(2, 0);
+  screen.setCursor(8, 0);
+  screen.print("abc");
+  screen.setCursor(11, 0);
+  screen.print("d");
+  direct.clear();
+  direct.setCursor(2, 0);
+  direct.setCursor(8, 0);
+  direct.print("abc");
+  direct.setCursor(11, 0);
+  direct.print("d");
+  assertEqual(direct.getLines().at(0), lcd.getLines().at(0));
+  assertEqual(2, screen.getElided());
+}
+
+unittest_main()
@@ -0,0 +1,182 @@
+#include <vector>
+
+#include "ArduinoUnitTests.h"
+#include "ci/ObservableDataStream.h"
+
+#include "LiquidCrystalFast.h"
+#include "LiquidCrystal_CI.h"
+
+const byte rs = 1;
+const byte rw = 2;
+const byte enable = 3;
+const byte d0 = 10;
+const byte d1 = 11;
+const byte d2 = 12;
+const byte d3 = 13;
+const byte d4 = 14;
+const byte d5 = 15;
+const byte d6 = 16;
+const byte d7 = 17;
+
+// same packing as the BitCollector in test.cpp: rs, rw, d7..d0
+class PinLog : public DataStreamObserver {
+private:
+  GodmodeState *state;
+
+public:
+  vector<int> values;
+
+  PinLog() : DataStreamObserver(false, false) {
+    state = GODMODE();
+    state->digitalPin[enable].addObserver("lcd", this);
+  }
+
+  ~PinLog() { state->digitalPin[enable].removeObserver("lcd"); }
+
+  virtual void onBit(bool aBit) {
+    if (aBit) {
+      const byte pins[] = {rs, rw, d7, d6, d5, d4, d3, d2, d1, d0};
+      int value = 0;
+      for (int i = 0; i < 10; ++i) {
+        value = (value << 1) + state->digitalPin[pins[i]];
+      }
+      values.push_back(value);
+    }
+  }
+
+  virtual String observerName() const { return "PinLog"; }
+};
+
+unittest(init_matches_liquidcrystal) {
+  vector<int> expected{48, 48, 48, 32, 32, 0, 0, 192, 0, 16, 0, 96};
+  PinLog pinValues;
+  LiquidCrystalFast_CI lcd(rs, enable, d4, d5, d6, d7);
+  assertTrue(expected == pinValues.values);
+}
+
+unittest(print_matches_liquidcrystal) {
+  GodmodeState *state = GODMODE();
+  vector<int> slowPins, fastPins;
+  unsigned long slowMicros, fastMicros, start;
+  {
+    LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+    lcd.begin(16, 2);
+    PinLog pinValues;
+    start = state->micros;
+    lcd.print("Hello");
+    lcd.clear();
+    slowMicros = state->micros - start;
+    slowPins = pinValues.values;
+  }
+  {
+    LiquidCrystalFast_CI lcd(rs, enable, d4, d5, d6, d7);
+    lcd.begin(16, 2);
+    PinLog pinValues;
+    start = state->micros;
+    lcd.print("Hello");
+    lcd.clear();
+    fastMicros = state->micros - start;
+    fastPins = pinValues.values;
+  }
+  assertTrue(slowPins == fastPins);
+  // 5 bytes at 3 * enable + data, then a clear
+  assertEqual(5 * (3 + 59) + (3 + 2160), fastMicros);
+  assertEqual(5 * 2 * 102 + (2 * 102 + 2000), slowMicros);
+}
+
+unittest(eight_bit_wiring) {
+  vector<int> expected{512 + 'H', 512 + 'i'};
+  LiquidCrystalFast_CI lcd(rs, rw, enable, d0, d1, d2, d3, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  PinLog pinValues;
+  unsigned long start = GODMODE()->micros;
+  lcd.print("Hi");
+  assertTrue(expected == pinValues.values);
+  assertEqual(2 * (1 + 59), GODMODE()->micros - start);
+  assertEqual("Hi", lcd.getLines().at(0));
+}
+
+unittest(timing_profiles) {
+  GodmodeState *state = GODMODE();
+  LiquidCrystalFast_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  // the datasheet's worst case unless a faster profile is chosen
+  assertEqual(53, lcd.getTiming().command);
+
+  lcd.setTiming(LCD_TIMING_HD44780);
+  unsigned long start = state->micros;
+  lcd.setCursor(3, 1);
+  assertEqual(3 + 37, state->micros - start);
+
+  lcd.setTiming(LCD_TIMING_CONSERVATIVE);
+  start = state->micros;
+  lcd.home();
+  assertEqual(3 + 2000, state->micros - start);
+  start = state->micros;
+  lcd.setCursor(3, 1);
+  assertEqual(3 + 100, state->micros - start);
+
+  // transfer() never waits; the caller owns the delay
+  start = state->micros;
+  assertEqual(100, lcd.transfer('x', HIGH));
+  assertEqual(3, state->micros - start);
+}
+
+unittest(shadow_state) {
+  LiquidCrystalFast_CI lcd(rs, enable, d4, d5, d6, d7);
+  assertEqual(&lcd, LiquidCrystalFast_CI::forRsPin(rs));
+  assertEqual(1, lcd.getRows());
+  lcd.begin(16, 2);
+  assertEqual(2, lcd.getRows());
+  assertTrue(lcd.isDisplay());
+
+  lcd.print(F("ABCD"));
+  lcd.setCursor(13, 1);
+  lcd.print(F("XYZ"));
+  assertEqual(16, lcd.getCursorCol());
+  assertEqual(1, lcd.getCursorRow());
+  std::vector<String> lines = lcd.getLines();
+  assertEqual(2, lines.size());
+  assertEqual("ABCD", lines.at(0));
+  assertEqual("             XYZ", lines.at(1));
+
+  lcd.blink();
+  lcd.cursor();
+  lcd.noDisplay();
+  assertTrue(lcd.isBlink());
+  assertTrue(lcd.isCursor());
+  assertFalse(lcd.isDisplay());
+
+  lcd.clear();
+  lines = lcd.getLines();
+  assertEqual(0, lines.at(0).length());
+  assertEqual(0, lines.at(1).length());
+  assertEqual(0, lcd.getCursorCol());
+}
+
+unittest(shadow_decodes_raw_commands) {
+  LiquidCrystalFast_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(20, 4);
+  lcd.command(LCD_SETDDRAMADDR | (20 + 2)); // row 2, col 2
+  lcd.write('!');
+  assertEqual(2, lcd.getCursorRow());
+  assertEqual(3, lcd.getCursorCol());
+  assertEqual("  !", lcd.getLines().at(2));
+  lcd.command(LCD_ENTRYMODESET | LCD_ENTRYLEFT | LCD_ENTRYSHIFTINCREMENT);
+  assertTrue(lcd.isAutoscroll());
+}
+
+unittest(createChar) {
+  LiquidCrystalFast_CI lcd(rs, enable, d4, d5, d6, d7);
+  byte smiley[8] = {B00000, B10001, B00000, B00000,
+                    B10001, B01110, B00000, B00000};
+  lcd.createChar(3, smiley);
+  byte *character = lcd.getCustomCharacter(3);
+  for (int bite = 0; bite < 8; bite++) {
+    assertEqual(smiley[bite], character[bite]);
+  }
+  // CGRAM writes are not screen text
+  assertEqual(0, lcd.getLines().at(0).length());
+}
+
+unittest_main()
@@ -0,0 +1,86 @@
+#include "ArduinoUnitTests.h"
+
+#include "LCDFleet.h"
+#include "LiquidCrystal_CI.h"
+
+unittest(fleet_of_ten_thousand) {
+  LCDFleet fleet(10000, 16, 2);
+  assertEqual(10000, fleet.size());
+  for (uint32_t device = 0; device < fleet.size(); ++device) {
+    LCDFleetDisplay lcd = fleet.display(device);
+    lcd.print("Unit ");
+    lcd.print(device);
+    lcd.setCursor(0, 1);
+    lcd.print(device % 1000 == 999 ? "ERR low battery" : "OK");
+  }
+  std::vector<uint32_t> failing = fleet.find("ERR");
+  assertEqual(10, failing.size());
+  assertEqual(999, failing.at(0));
+  assertEqual(9999, failing.at(9));
+  assertEqual("Unit 9999       ", fleet.getLine(9999, 0));
+  assertEqual("ERR low battery ", fleet.getLine(9999, 1));
+  assertEqual(15, fleet.getCursorCol(9999));
+  assertEqual(1, fleet.getCursorRow(9999));
+
+  // text only matches within a row
+  assertEqual(0, fleet.find("       O").size());
+  assertEqual(1, fleet.find("Unit 4242").size());
+
+  ScreenPattern pattern("Unit #", "OK");
+  std::vector<uint32_t> single = fleet.findMatching(pattern);
+  assertEqual(10, single.size());
+  assertEqual(9, single.back());
+}
+
+unittest(fleet_flags_and_custom_characters) {
+  LCDFleet fleet(100, 20, 4);
+  for (uint32_t device = 0; device < fleet.size(); device += 10) {
+    LCDFleetDisplay lcd = fleet.display(device);
+    lcd.display();
+    lcd.blink();
+  }
+  fleet.display(50).noBlink();
+  std::vector<uint32_t> blinking = fleet.findWithFlags(
+      LCDFleet::FLAG_DISPLAY | LCDFleet::FLAG_BLINK,
+      LCDFleet::FLAG_DISPLAY | LCDFleet::FLAG_BLINK);
+  assertEqual(9, blinking.size());
+  assertEqual(60, blinking.at(5));
+
+  const uint8_t bell[8] = {4, 14, 14, 14, 31, 0, 4, 0};
+  fleet.display(7).createChar(3, bell);
+  assertEqual(0, memcmp(bell, fleet.getCustomCharacter(7, 3), 8));
+  assertEqual(0, fleet.getCustomCharacter(8, 3)[0]);
+}
+
+unittest(fleet_follows_liquidcrystal_ci) {
+  LiquidCrystal_CI lcd(1, 3, 14, 15, 16, 17);
+  lcd.begin(16, 2);
+  LCDFleet fleet(3, 16, 2);
+  LCDFleetDisplay device = fleet.display(1);
+
+  lcd.print("hello");
+  device.print("hello");
+  lcd.setCursor(10, 1);
+  device.setCursor(10, 1);
+  lcd.autoscroll();
+  device.autoscroll();
+  lcd.print("abc");
+  device.print("abc");
+  lcd.noAutoscroll();
+  device.noAutoscroll();
+  lcd.print("!");
+  device.print("!");
+
+  std::vector<String> lines = lcd.getLines();
+  for (int row = 0; row < 2; ++row) {
+    String line = lines.at(row);
+    while (line.length() < 16) {
+      line += ' ';
+    }
+    assertEqual(line, fleet.getLine(1, row));
+  }
+  assertEqual(lcd.getCursorCol(), fleet.getCursorCol(1));
+  assertEqual("                ", fleet.getLine(0, 0));
+}
+
+unittest_main()
@@ -0,0 +1,112 @@
+#include "ArduinoUnitTests.h"
+#include "PulseCounter.h"
+
+#include "LCDGlyphCache.h"
+
+// a distinct bitmap per n
+void glyph(uint8_t n, uint8_t bitmap[8]) {
+  for (int i = 0; i < 8; ++i) {
+    bitmap[i] = (n + i) & 0x1F;
+  }
+}
+
+unittest(identical_bitmaps_share_a_slot) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LCDGlyphCache<16, 2> glyphs(lcd);
+  uint8_t bell[8], copy[8];
+  glyph(1, bell);
+  glyph(1, copy);
+
+  assertTrue(glyphs.draw(0, 0, bell));
+  assertTrue(glyphs.draw(5, 1, copy));
+  assertTrue(glyphs.draw(6, 1, bell));
+  assertEqual(1, glyphs.getMisses());
+  assertEqual(2, glyphs.getHits());
+  assertEqual(3, glyphs.getVisible(0));
+  assertEqual(0, memcmp(bell, lcd.getCustomCharacter(0), 8));
+  std::vector<String> lines = lcd.getLines();
+  assertEqual('\0', lines.at(0)[0]);
+  assertEqual('\0', lines.at(1)[5]);
+  assertEqual('\0', lines.at(1)[6]);
+}
+
+unittest(resident_glyphs_are_not_uploaded_again) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LCDGlyphCache<16, 2> glyphs(lcd);
+  uint8_t bitmap[8];
+  glyph(7, bitmap);
+  PulseCounter counter;
+
+  glyphs.draw(0, 0, bitmap);
+  // set CGRAM address + 8 rows, then set DDRAM address + the character
+  assertEqual(2 * (1 + 8 + 1 + 1), counter.pulses);
+  counter.pulses = 0;
+  glyphs.draw(1, 0, bitmap);
+  assertEqual(2 * (1 + 1), counter.pulses);
+  counter.pulses = 0;
+  // already showing it
+  glyphs.draw(1, 0, bitmap);
+  assertEqual(0, counter.pulses);
+}
+
+unittest(least_recently_used_slot_is_reused) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LCDGlyphCache<16, 2> glyphs(lcd);
+  uint8_t bitmap[8];
+  for (int n = 0; n < 8; ++n) {
+    glyph(n, bitmap);
+    assertEqual(n, glyphs.load(bitmap));
+  }
+  glyph(0, bitmap);
+  assertEqual(0, glyphs.load(bitmap));
+  // slot 1 is now the least recently used
+  glyph(8, bitmap);
+  assertEqual(1, glyphs.load(bitmap));
+  assertEqual(0, memcmp(bitmap, lcd.getCustomCharacter(1), 8));
+  assertEqual(9, glyphs.getMisses());
+  assertEqual(1, glyphs.getHits());
+  assertEqual(1, glyphs.getEvictions());
+}
+
+unittest(visible_glyphs_are_never_evicted) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LCDGlyphCache<16, 2> glyphs(lcd);
+  uint8_t bitmap[8];
+  for (int n = 0; n < 8; ++n) {
+    glyph(n, bitmap);
+    assertTrue(glyphs.draw(n, 0, bitmap));
+  }
+  PulseCounter counter;
+  glyph(8, bitmap);
+  assertFalse(glyphs.draw(8, 0, bitmap));
+  assertEqual(-1, glyphs.load(bitmap));
+  assertEqual(0, counter.pulses);
+
+  // printing over the third glyph frees its slot
+  glyphs.release(2, 0);
+  lcd.setCursor(2, 0);
+  lcd.print("x");
+  assertTrue(glyphs.draw(8, 0, bitmap));
+  assertEqual(1, glyphs.getEvictions());
+  assertEqual(0, memcmp(bitmap, lcd.getCustomCharacter(2), 8));
+  for (int n = 0; n < 8; ++n) {
+    uint8_t shown[8];
+    glyph(n, shown);
+    if (n != 2) {
+      assertEqual(0, memcmp(shown, lcd.getCustomCharacter(n), 8));
+    }
+  }
+
+  // a cell's own glyph can make way for the glyph replacing it
+  glyph(9, bitmap);
+  assertTrue(glyphs.draw(8, 0, bitmap));
+  assertEqual(1, glyphs.getVisible(2));
+  glyphs.clear();
+  assertEqual(0, glyphs.getVisible(2));
+}
+
+unittest_main()
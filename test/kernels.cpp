@@ -0,0 +1,79 @@
+#include "ArduinoUnitTests.h"
+
+#include "LCDScreenKernels.h"
+#include <vector>
+
+// deterministic bytes from a small alphabet, so that needles and equal runs
+// turn up often
+class Bytes {
+public:
+  Bytes(uint32_t seed) : _state(seed) {}
+  uint8_t next(uint8_t alphabet) {
+    _state = _state * 1103515245 + 12345;
+    return 'a' + (_state >> 16) % alphabet;
+  }
+
+private:
+  uint32_t _state;
+};
+
+unittest(find_matches_scalar) {
+  Bytes bytes(1);
+  std::vector<uint8_t> data(1000);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = bytes.next(4);
+  }
+  for (size_t length = 1; length <= 24; ++length) {
+    for (int trial = 0; trial < 20; ++trial) {
+      uint8_t needle[24];
+      for (size_t i = 0; i < length; ++i) {
+        needle[i] = bytes.next(4);
+      }
+      // every alignment and size, including ones shorter than a block
+      size_t start = trial % 17;
+      size_t size = data.size() - start - trial * 37;
+      assertEqual(
+          LCDScreenKernels::findScalar(&data[start], size, needle, length),
+          LCDScreenKernels::find(&data[start], size, needle, length));
+      assertEqual(LCDScreenKernels::findScalar(&data[start], trial, needle,
+                                               length),
+                  LCDScreenKernels::find(&data[start], trial, needle, length));
+    }
+  }
+  const uint8_t end[] = "xyz";
+  data[997] = 'x';
+  data[998] = 'y';
+  data[999] = 'z';
+  assertEqual(997, LCDScreenKernels::find(&data[0], 1000, end, 3));
+  assertEqual(LCDScreenKernels::NOT_FOUND,
+              LCDScreenKernels::find(&data[0], 999, end, 3));
+}
+
+unittest(comparisons_match_scalar) {
+  Bytes bytes(2);
+  std::vector<uint8_t> a(777), b;
+  for (size_t i = 0; i < a.size(); ++i) {
+    a[i] = bytes.next(26);
+  }
+  for (int trial = 0; trial < 200; ++trial) {
+    b = a;
+    // a few differences at random places, sometimes none
+    for (int changes = trial % 4; changes > 0; --changes) {
+      b[(bytes.next(26) * 31 + trial * 7) % b.size()] = '!';
+    }
+    size_t start = trial % 19;
+    size_t size = a.size() - start - trial;
+    const uint8_t *x = &a[start], *y = &b[start];
+    assertEqual(LCDScreenKernels::equalScalar(x, y, size),
+                LCDScreenKernels::equal(x, y, size));
+    assertEqual(LCDScreenKernels::countDiffScalar(x, y, size),
+                LCDScreenKernels::countDiff(x, y, size));
+    assertEqual(LCDScreenKernels::firstDiffScalar(x, y, size),
+                LCDScreenKernels::firstDiff(x, y, size));
+  }
+  assertTrue(LCDScreenKernels::equal(&a[0], &a[0], a.size()));
+  assertEqual(0, LCDScreenKernels::countDiff(&a[0], &a[0], a.size()));
+  assertEqual(a.size(), LCDScreenKernels::firstDiff(&a[0], &a[0], a.size()));
+}
+
+unittest_main()
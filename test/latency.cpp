@@ -0,0 +1,198 @@
+#include "ArduinoUnitTests.h"
+
+#include "LCDLatencyTracer.h"
+
+const byte rs = 1;
+const byte enable = 3;
+const byte d4 = 14;
+const byte d5 = 15;
+const byte d6 = 16;
+const byte d7 = 17;
+const byte button = 5;
+
+int occurrences(const String &text, char c) {
+  int count = 0;
+  for (size_t i = 0; i < text.length(); ++i) {
+    count += text[i] == c;
+  }
+  return count;
+}
+
+// a sketch that shows a menu some time after the button goes low
+class MenuSketch {
+public:
+  LiquidCrystal_CI &lcd;
+  unsigned long debounce;
+  bool shown;
+
+  MenuSketch(LiquidCrystal_CI &lcd) : lcd(lcd), debounce(5), shown(false) {}
+
+  void loop() {
+    bool pressed = digitalRead(button) == LOW;
+    if (pressed && !shown) {
+      delay(debounce);
+      lcd.clear();
+      lcd.setCursor(0, 0);
+      lcd.print("Menu");
+      shown = true;
+    } else if (!pressed && shown) {
+      lcd.clear();
+      lcd.setCursor(0, 0);
+      lcd.print("Idle");
+      shown = false;
+    }
+  }
+};
+
+unittest(latency_is_measured_to_the_last_byte) {
+  GodmodeState *state = GODMODE();
+  state->reset();
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  MenuSketch sketch(lcd);
+  LCDLatencyTracer whole(lcd), part(lcd);
+
+  state->digitalPin[button] = HIGH;
+  sketch.loop();
+  state->digitalPin[button] = LOW;
+  whole.mark("Menu");
+  part.mark("Men");
+  assertTrue(whole.isWaiting());
+  sketch.loop();
+  assertFalse(whole.isWaiting());
+  assertFalse(part.isWaiting());
+  assertEqual(1, whole.getCount());
+  // the debounce delay and clear() at least
+  assertMoreOrEqual(whole.getLast(), 5000 + 1520);
+  assertMore(whole.getLast(), part.getLast());
+  assertEqual(0, whole.getMissed());
+
+  // text scrolled past the last column isn't visible
+  whole.mark("Hidden");
+  lcd.setCursor(14, 1);
+  lcd.print("Hidden");
+  assertTrue(whole.isWaiting());
+  lcd.setCursor(0, 1);
+  lcd.print("Hidden");
+  assertFalse(whole.isWaiting());
+
+  // as is text outside the shifted window, until it scrolls in
+  whole.mark("Later");
+  lcd.setCursor(16, 0);
+  lcd.print("Later");
+  for (int step = 0; step < 4; ++step) {
+    lcd.scrollDisplayLeft();
+  }
+  assertTrue(whole.isWaiting());
+  lcd.scrollDisplayLeft();
+  assertFalse(whole.isWaiting());
+}
+
+unittest(patterns_and_missed_measurements) {
+  GodmodeState *state = GODMODE();
+  state->reset();
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LCDLatencyTracer tracer(lcd);
+
+  tracer.mark(ScreenPattern("T=##"));
+  lcd.print("T=4");
+  assertTrue(tracer.isWaiting());
+  lcd.print("2");
+  assertFalse(tracer.isWaiting());
+
+  tracer.mark("never");
+  tracer.mark("T=");
+  assertEqual(1, tracer.getMissed());
+  // already on screen, so it has to be drawn again
+  lcd.home();
+  assertTrue(tracer.isWaiting());
+  delay(3);
+  lcd.clear();
+  lcd.setCursor(0, 0);
+  assertTrue(tracer.isWaiting());
+  lcd.print("T=5");
+  assertFalse(tracer.isWaiting());
+  assertMoreOrEqual(tracer.getLast(), 3000);
+  tracer.mark("gone");
+  tracer.cancel();
+  assertEqual(2, tracer.getMissed());
+  assertEqual(2, tracer.getCount());
+
+  // patterns are matched against the shifted window, not DDRAM
+  lcd.clear();
+  tracer.mark(ScreenPattern("OK"));
+  lcd.setCursor(2, 0);
+  lcd.print("OK");
+  assertTrue(tracer.isWaiting());
+  lcd.scrollDisplayLeft();
+  assertTrue(tracer.isWaiting());
+  lcd.scrollDisplayLeft();
+  assertFalse(tracer.isWaiting());
+}
+
+unittest(nothing_is_visible_while_the_display_is_off) {
+  GodmodeState *state = GODMODE();
+  state->reset();
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LCDLatencyTracer text(lcd), pattern(lcd);
+
+  lcd.noDisplay();
+  text.mark("Ready");
+  pattern.mark(ScreenPattern("Ready"));
+  lcd.print("Ready");
+  assertTrue(text.isWaiting());
+  assertTrue(pattern.isWaiting());
+  delay(2);
+  lcd.display();
+  assertFalse(text.isWaiting());
+  assertFalse(pattern.isWaiting());
+  assertMoreOrEqual(text.getLast(), 2000);
+  assertEqual(text.getLast(), pattern.getLast());
+}
+
+unittest(histogram_across_runs) {
+  GodmodeState *state = GODMODE();
+  state->reset();
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  MenuSketch sketch(lcd);
+  LCDLatencyTracer tracer(lcd);
+
+  for (int run = 0; run < 20; ++run) {
+    sketch.debounce = 1 + run % 4;
+    state->digitalPin[button] = LOW;
+    tracer.mark("Menu");
+    while (tracer.isWaiting()) {
+      sketch.loop();
+    }
+    state->digitalPin[button] = HIGH;
+    sketch.loop();
+  }
+  assertEqual(20, tracer.getCount());
+  const std::vector<unsigned long> &samples = tracer.getSamples();
+  // the same work each time, apart from the debounce delay
+  assertEqual(samples[1] - samples[0], 1000);
+  assertEqual(samples[0], tracer.getMin());
+  assertEqual(samples[3], tracer.getMax());
+  assertEqual(samples[0] + 1500, tracer.getMean());
+  assertEqual(samples[1], tracer.getPercentile(50));
+  assertEqual(samples[3], tracer.getPercentile(100));
+
+  unsigned long first;
+  std::vector<unsigned long> buckets = tracer.getBuckets(1000, &first);
+  assertEqual(4, buckets.size());
+  assertEqual(samples[0] / 1000 * 1000, first);
+  assertEqual(5, buckets[0]);
+  assertEqual(5, buckets[3]);
+  String histogram = tracer.getHistogram(1000);
+  assertEqual(4, occurrences(histogram, '\n'));
+  assertEqual(160, occurrences(histogram, '#'));
+
+  tracer.reset();
+  assertEqual(0, tracer.getCount());
+  assertEqual("", tracer.getHistogram());
+}
+
+unittest_main()
@@ -0,0 +1,92 @@
+#include <vector>
+
+#include "ArduinoUnitTests.h"
+#include "ci/ObservableDataStream.h"
+
+#include "LiquidCrystalFast.h"
+#include "LiquidCrystal_CI.h"
+
+#define LCDTRACE_NO_MAIN
+#include "../extras/lcdtrace/lcdtrace.cpp"
+
+const byte rs = 1;
+const byte enable = 3;
+const byte d4 = 14;
+const byte d5 = 15;
+const byte d6 = 16;
+const byte d7 = 17;
+
+// the trace words lcdtrace reads: rs in bit 9, rw (not wired) in bit 8,
+// d7..d4 in bits 7..4
+class TraceCapture : public DataStreamObserver {
+private:
+  GodmodeState *state;
+
+public:
+  std::vector<unsigned> words;
+
+  TraceCapture() : DataStreamObserver(false, false) {
+    state = GODMODE();
+    state->reset();
+    state->digitalPin[enable].addObserver("lcd", this);
+  }
+
+  ~TraceCapture() { state->digitalPin[enable].removeObserver("lcd"); }
+
+  virtual void onBit(bool aBit) {
+    if (aBit) {
+      words.push_back(state->digitalPin[rs] << 9 | state->digitalPin[d7] << 7 |
+                      state->digitalPin[d6] << 6 | state->digitalPin[d5] << 5 |
+                      state->digitalPin[d4] << 4);
+    }
+  }
+
+  virtual String observerName() const { return "TraceCapture"; }
+};
+
+// the screen lcdtrace reconstructs from the words
+std::vector<String> decode(const std::vector<unsigned> &words) {
+  Output out;
+  Controller controller(out, 16, 2, false);
+  for (size_t i = 0; i < words.size(); ++i) {
+    controller.word(i, words[i], false, false);
+  }
+  std::vector<String> lines;
+  char text[17];
+  for (int row = 0; row < 2; ++row) {
+    controller.line(row, text);
+    lines.push_back(text);
+  }
+  return lines;
+}
+
+unittest(decodes_power_on_and_text) {
+  TraceCapture trace;
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  lcd.print("Hello");
+  lcd.setCursor(3, 1);
+  lcd.print("world");
+
+  std::vector<String> lines = decode(trace.words);
+  assertEqual("Hello           ", lines.at(0));
+  assertEqual("   world        ", lines.at(1));
+}
+
+unittest(cursor_shift_ignores_entry_mode) {
+  TraceCapture trace;
+  LiquidCrystalFast_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  lcd.print("abcd");
+  // writes now move the cursor left, but a cursor shift goes where R/L says
+  lcd.rightToLeft();
+  lcd.command(LCD_CURSORSHIFT | LCD_CURSORMOVE | LCD_MOVERIGHT);
+  lcd.write('R');
+  lcd.command(LCD_CURSORSHIFT | LCD_CURSORMOVE | LCD_MOVELEFT);
+  lcd.write('L');
+
+  std::vector<String> lines = decode(trace.words);
+  assertEqual("abcL R          ", lines.at(0));
+}
+
+unittest_main()
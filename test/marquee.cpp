@@ -0,0 +1,115 @@
+#include "ArduinoUnitTests.h"
+#include "PulseCounter.h"
+
+#include "LCDMarquee.h"
+
+// what a marquee should show: the text repeating with gap spaces
+String expected(const char *text, int gap, unsigned long offset, int cols) {
+  int length = strlen(text), period = length + gap;
+  String window;
+  for (int col = 0; col < cols; ++col) {
+    int index = (offset + col) % period;
+    window += index < length ? text[index] : ' ';
+  }
+  return window;
+}
+
+unittest(shadow_models_the_display_shift) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  lcd.print("abcdefghijklmnopq");
+  lcd.setCursor(39, 1);
+  lcd.print("Z");
+  assertEqual(0, lcd.getShift());
+  assertEqual("abcdefghijklmnop", lcd.getVisibleLines().at(0));
+
+  lcd.scrollDisplayLeft();
+  lcd.scrollDisplayLeft();
+  assertEqual(2, lcd.getShift());
+  assertEqual("cdefghijklmnopq ", lcd.getVisibleLines().at(0));
+  // lines shift together, and wrap at 40
+  lcd.scrollDisplayRight();
+  lcd.scrollDisplayRight();
+  lcd.scrollDisplayRight();
+  assertEqual(39, lcd.getShift());
+  assertEqual(" abcdefghijklmno", lcd.getVisibleLines().at(0));
+  assertEqual("Z               ", lcd.getVisibleLines().at(1));
+  // DDRAM itself doesn't move
+  assertEqual("abcdefghijklmnopq", lcd.getLines().at(0));
+
+  lcd.home();
+  assertEqual(0, lcd.getShift());
+  lcd.scrollDisplayLeft();
+  lcd.clear();
+  assertEqual(0, lcd.getShift());
+
+  // recorded in order with writes in lazy mode
+  lcd.setLazy(true);
+  lcd.setCursor(0, 0);
+  lcd.print("xy");
+  lcd.scrollDisplayLeft();
+  lcd.home();
+  lcd.scrollDisplayLeft();
+  assertEqual(1, lcd.getShift());
+  assertEqual("y               ", lcd.getVisibleLines().at(0));
+}
+
+unittest(window_shows_the_text_at_every_step) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  const char *text = "Gate 7 closes at 10:45 - please proceed to the gate";
+  LCDMarquee banner(lcd, 1, 16);
+  banner.setText(text, 5);
+  for (int step = 0; step < 500; ++step) {
+    assertEqual(expected(text, 5, step, 16), lcd.getVisibleLines().at(1));
+    assertEqual(step % (strlen(text) + 5), banner.getOffset());
+    banner.step();
+  }
+
+  // a short text repeats within one DDRAM line
+  banner.setText("Hi", 1);
+  for (int step = 0; step < 100; ++step) {
+    assertEqual(expected("Hi", 1, step, 16), lcd.getVisibleLines().at(1));
+    banner.step();
+  }
+
+  // the other line, written through columnFor(), stays put
+  lcd.setCursor(banner.columnFor(0), 0);
+  lcd.print("Now");
+  assertEqual("Now", lcd.getVisibleLines().at(0).substring(0, 3));
+
+  // a 40-column display has nothing off screen
+  LiquidCrystal_CI wide(rs, enable, d4, d5, d6, d7);
+  wide.begin(40, 2);
+  LCDMarquee full(wide, 0, 40);
+  full.setText(text, 2);
+  for (int step = 0; step < 120; ++step) {
+    full.step();
+    assertEqual(expected(text, 2, step + 1, 40),
+                wide.getVisibleLines().at(0));
+  }
+}
+
+unittest(steps_are_one_instruction_between_refills) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LCDMarquee banner(lcd, 0, 16);
+  banner.setText("The quick brown fox jumps over the lazy dog");
+  PulseCounter counter;
+  unsigned long quiet = 0;
+  for (int step = 0; step < 240; ++step) {
+    unsigned long refills = banner.getRefills();
+    counter.pulses = 0;
+    banner.step();
+    if (banner.getRefills() == refills) {
+      assertEqual(2, counter.pulses);
+      ++quiet;
+    }
+  }
+  // a refill writes the 24 columns off screen, so one is due every 24
+  // steps from the 25th
+  assertEqual(9, banner.getRefills());
+  assertEqual(240 - 9, quiet);
+}
+
+unittest_main()
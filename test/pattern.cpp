@@ -0,0 +1,87 @@
+#include "ArduinoUnitTests.h"
+
+#include "LiquidCrystal_CI.h"
+#include "ScreenPattern.h"
+
+const byte rs = 1;
+const byte enable = 3;
+const byte d4 = 14;
+const byte d5 = 15;
+const byte d6 = 16;
+const byte d7 = 17;
+
+unittest(literal_and_wildcards) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  lcd.print("Temp: 21.5 C");
+  lcd.setCursor(0, 1);
+  lcd.print("anything");
+
+  assertTrue(lcd.matches(ScreenPattern("Temp: ??.? C")));
+  assertTrue(lcd.matches(ScreenPattern("Temp: ##.# C", "*")));
+  assertTrue(lcd.matches(ScreenPattern("Temp: *")));
+  assertTrue(lcd.matches(ScreenPattern("Temp: [0-9][0-9].# C", "any?hing")));
+  assertFalse(lcd.matches(ScreenPattern("Temp: ##.# F")));
+  // trailing cells must be blank unless the row ends with *
+  assertFalse(lcd.matches(ScreenPattern("Temp: ")));
+  assertFalse(lcd.matches(ScreenPattern("Temp: ##.# C", "")));
+  // unwritten cells count as blank
+  assertTrue(lcd.matches(ScreenPattern("Temp: ##.# C   ", "anything  ")));
+  // more rows than the screen has
+  assertFalse(lcd.matches(ScreenPattern("*", "*", "*")));
+}
+
+unittest(classes_and_escapes) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  lcd.print("#1 ?*x] OK");
+
+  assertTrue(lcd.matches(ScreenPattern("\\#1 \\?\\*x] [A-Z][^a-z]")));
+  assertTrue(lcd.matches(ScreenPattern("\\#[123] ??[x-z][]] OK")));
+  assertFalse(lcd.matches(ScreenPattern("\\#[^1] ??x] OK")));
+  assertFalse(ScreenPattern("[0-9").isValid());
+  assertFalse(ScreenPattern("{9}").isValid());
+  assertFalse(ScreenPattern("ab\\").isValid());
+  assertFalse(lcd.matches(ScreenPattern("[0-9")));
+  // a malformed row reads as empty
+  ScreenPattern malformed("[0-9");
+  const uint8_t blank[4] = {' ', ' ', ' ', ' '};
+  const uint8_t digits[4] = {'0', '1', '2', '3'};
+  assertTrue(malformed.matchesRow(0, blank, 4));
+  assertFalse(malformed.matchesRow(0, digits, 4));
+}
+
+unittest(custom_characters) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  byte bar[8] = {B11111, B11111, B11111, B11111,
+                 B11111, B11111, B11111, B11111};
+  lcd.createChar(2, bar);
+  lcd.setCursor(0, 0);
+  lcd.write(2);
+  lcd.write(8 + 2);
+  lcd.print("%");
+  assertTrue(lcd.matches(ScreenPattern("{2}{2}%")));
+  assertFalse(lcd.matches(ScreenPattern("{3}{2}%")));
+}
+
+unittest(wide_rows) {
+  char row[41];
+  memset(row, 'x', 40);
+  row[40] = '\0';
+  assertTrue(ScreenPattern(row).isValid());
+  row[39] = '?';
+  const uint8_t text[40] = {'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x',
+                            'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x',
+                            'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x',
+                            'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', 'x', '!'};
+  assertTrue(ScreenPattern(row).matchesRow(0, text, 40));
+  assertFalse(ScreenPattern(row).matchesRow(0, text, 20));
+  assertFalse(ScreenPattern("x").matchesRow(0, text, 40));
+  char wide[42];
+  memset(wide, 'x', 41);
+  wide[41] = '\0';
+  assertFalse(ScreenPattern(wide).isValid());
+}
+
+unittest_main()
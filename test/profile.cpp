@@ -0,0 +1,138 @@
+#include "ArduinoUnitTests.h"
+
+#include "LiquidCrystal_CI.h"
+#include <thread>
+#include <unistd.h>
+
+const byte rs = 1;
+const byte enable = 3;
+const byte d4 = 14;
+const byte d5 = 15;
+const byte d6 = 16;
+const byte d7 = 17;
+
+// two screens, each with two call sites
+__attribute__((noinline)) void drawHeader(LiquidCrystal_CI &lcd) {
+  lcd.setCursor(0, 0);
+  lcd.print("Status");
+}
+
+__attribute__((noinline)) void drawReadings(LiquidCrystal_CI &lcd, int n) {
+  lcd.setCursor(0, 1);
+  lcd.print(n * 1000 + 123);
+}
+
+unittest(bus_time_is_charged_to_call_sites) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LCDCallSiteProfile profile;
+  lcd.profileTo(&profile);
+  unsigned long start = micros();
+  for (int n = 0; n < 10; ++n) {
+    drawHeader(lcd);
+    drawReadings(lcd, n);
+  }
+  unsigned long elapsed = micros() - start;
+  unsigned long pulses = profile.getPulses();
+  lcd.profileTo(nullptr);
+  lcd.print("not counted");
+
+  std::vector<LCDCallSiteProfile::Site> sites = profile.getSites();
+  assertEqual(4, sites.size());
+  unsigned long micros = 0, counted = 0;
+  for (size_t i = 0; i < sites.size(); ++i) {
+    // the writes inside print() are part of its call
+    assertEqual(10, sites[i].calls);
+    micros += sites[i].micros;
+    counted += sites[i].pulses;
+    if (i) {
+      assertMoreOrEqual(sites[i - 1].micros, sites[i].micros);
+    }
+  }
+  // all the time the mocks spent is in display calls
+  assertEqual(elapsed, micros);
+  assertEqual(pulses, counted);
+  // "Status" is six characters, two pulses each
+  assertEqual(10 * 6 * 2, sites[0].pulses);
+  assertEqual(0, profile.getDropped());
+
+  String report = profile.getReport();
+  assertEqual(0, report.indexOf("    bus us"));
+  // header, four sites
+  int lines = 0;
+  for (size_t i = 0; i < report.length(); ++i) {
+    lines += report[i] == '\n';
+  }
+  assertEqual(5, lines);
+  if (access("/usr/bin/addr2line", X_OK) == 0) {
+    assertTrue(report.indexOf("drawHeader") > 0);
+    assertTrue(report.indexOf("drawReadings") > 0);
+  }
+
+  profile.reset();
+  assertEqual(0, profile.getSites().size());
+}
+
+// each task's screen, drawn from its own thread
+__attribute__((noinline)) void drawTask(LiquidCrystal_CI &lcd, int task) {
+  lcd.setCursor(0, task);
+  lcd.print("x");
+}
+
+unittest(queued_calls_are_charged_to_their_sites) {
+  const int tasks = 4;
+  const int count = 100;
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 4);
+  LCDCallSiteProfile profile;
+  lcd.profileTo(&profile);
+  // a small queue, so producers also have to apply calls themselves
+  lcd.setConcurrent(true, 16);
+  std::vector<std::thread> threads;
+  for (int task = 0; task < tasks; ++task) {
+    threads.push_back(std::thread([&lcd, task, count]() {
+      for (int i = 0; i < count; ++i) {
+        drawTask(lcd, task);
+      }
+    }));
+  }
+  for (int task = 0; task < tasks; ++task) {
+    threads.at(task).join();
+  }
+  lcd.applyPending();
+  lcd.setConcurrent(false);
+  lcd.profileTo(nullptr);
+
+  // the setCursor() and print() in drawTask, not the code applying them
+  std::vector<LCDCallSiteProfile::Site> sites = profile.getSites();
+  assertEqual(2, sites.size());
+  unsigned long pulses = 0;
+  for (size_t i = 0; i < sites.size(); ++i) {
+    assertEqual(tasks * count, sites[i].calls);
+    pulses += sites[i].pulses;
+  }
+  assertEqual(profile.getPulses(), pulses);
+  assertEqual(tasks * count * 2 * 2, pulses);
+  if (access("/usr/bin/addr2line", X_OK) == 0) {
+    String report = profile.getReport();
+    assertTrue(report.indexOf("drawTask") > 0);
+    assertTrue(report.indexOf("LiquidCrystal_CI::call") < 0);
+  }
+}
+
+unittest(full_table_drops_new_sites) {
+  LCDCallSiteProfile profile;
+  // made-up sites; the report just can't name them
+  uintptr_t code = 0x1000;
+  size_t room = LCDCallSiteProfile::CAPACITY / 4 * 3;
+  for (size_t i = 0; i < room + 5; ++i) {
+    profile.add((const void *)(code + i), 10, 2);
+  }
+  profile.add((const void *)code, 10, 2);
+  assertEqual(room, profile.getSites().size());
+  assertEqual(5, profile.getDropped());
+  assertEqual(2, profile.getSites()[0].calls);
+  assertTrue(profile.getReport(3).indexOf("5 calls from further sites") > 0);
+}
+
+unittest_main()
@@ -0,0 +1,146 @@
+#include <vector>
+
+#include "ArduinoUnitTests.h"
+#include "ci/ObservableDataStream.h"
+
+#include "LiquidCrystalQueue.h"
+
+const byte rs = 1;
+const byte enable = 3;
+const byte d4 = 14;
+const byte d5 = 15;
+const byte d6 = 16;
+const byte d7 = 17;
+
+// virtual time of every enable pulse
+class PulseTimes : public DataStreamObserver {
+private:
+  GodmodeState *state;
+
+public:
+  vector<unsigned long> times;
+
+  PulseTimes() : DataStreamObserver(false, false) {
+    state = GODMODE();
+    state->digitalPin[enable].addObserver("lcd", this);
+  }
+
+  ~PulseTimes() { state->digitalPin[enable].removeObserver("lcd"); }
+
+  virtual void onBit(bool aBit) {
+    if (aBit) {
+      times.push_back(state->micros);
+    }
+  }
+
+  virtual String observerName() const { return "PulseTimes"; }
+};
+
+unittest(queue_does_not_block) {
+  LiquidCrystalFast_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LiquidCrystalQueue<32> queue(lcd);
+  PulseTimes pulses;
+
+  unsigned long start = GODMODE()->micros;
+  assertTrue(queue.clear());
+  assertEqual(5, queue.print("Hello"));
+  assertTrue(queue.setCursor(3, 1));
+  assertEqual(2, queue.print(42));
+  // queueing doesn't touch the bus or the clock
+  assertEqual(start, GODMODE()->micros);
+  assertEqual(0, pulses.times.size());
+  assertEqual(9, queue.pending());
+  assertFalse(queue.isDone());
+
+  while (!queue.isDone()) {
+    queue.poll();
+    delayMicroseconds(10); // the rest of loop()
+  }
+  assertEqual(9, queue.getTransfers());
+  // each poll() only pays for the enable pulses of one 4-bit transfer
+  assertEqual(3 * lcd.getTiming().enable, queue.getWorstPollMicros());
+
+  std::vector<String> lines = lcd.getLines();
+  assertEqual("Hello", lines.at(0));
+  assertEqual("   42", lines.at(1));
+}
+
+unittest(queue_paces_transfers) {
+  LiquidCrystalFast_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LiquidCrystalQueue<8> queue(lcd);
+  PulseTimes pulses;
+
+  queue.clear();
+  queue.write('A');
+  while (!queue.isDone()) {
+    queue.poll();
+    delayMicroseconds(1);
+  }
+  // two pulses per transfer; the data write waits out the clear
+  assertEqual(4, pulses.times.size());
+  assertMoreOrEqual(pulses.times.at(2) - pulses.times.at(1),
+                    (unsigned long)lcd.getTiming().clearHome);
+  assertEqual("A", lcd.getLines().at(0));
+}
+
+unittest(queue_rejects_when_full) {
+  LiquidCrystalFast_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LiquidCrystalQueue<4> queue(lcd);
+  assertEqual(4, queue.capacity());
+  assertEqual(4, queue.print("abcdef"));
+  assertEqual(2, queue.getDropped());
+  assertFalse(queue.command(LCD_RETURNHOME));
+  assertEqual(3, queue.getDropped());
+  assertTrue(queue.poll());
+  // still executing the first write
+  assertFalse(queue.poll());
+  assertEqual(1, queue.write('e'));
+  while (!queue.isDone()) {
+    queue.poll();
+    delayMicroseconds(5);
+  }
+  assertEqual("abcde", lcd.getLines().at(0));
+}
+
+unittest(queue_toggles_and_custom_characters) {
+  LiquidCrystalFast_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LiquidCrystalQueue<16> queue(lcd);
+  PulseTimes pulses;
+  byte smiley[8] = {0, 10, 10, 0, 17, 14, 0, 0};
+
+  assertTrue(queue.cursor());
+  assertTrue(queue.blink());
+  assertTrue(queue.noDisplay());
+  assertTrue(queue.createChar(2, smiley));
+  assertEqual(12, queue.pending());
+  assertEqual(0, pulses.times.size());
+  // nine more transfers don't fit, so none of them is queued
+  assertFalse(queue.createChar(3, smiley));
+  assertEqual(12, queue.pending());
+  assertEqual(9, queue.getDropped());
+
+  while (!queue.isDone()) {
+    queue.poll();
+    delayMicroseconds(10);
+  }
+  assertTrue(lcd.isCursor());
+  assertTrue(lcd.isBlink());
+  assertFalse(lcd.isDisplay());
+  assertEqual(0, memcmp(smiley, lcd.getCustomCharacter(2), 8));
+
+  queue.display();
+  queue.noBlink();
+  while (!queue.isDone()) {
+    queue.poll();
+    delayMicroseconds(10);
+  }
+  assertTrue(lcd.isDisplay());
+  assertTrue(lcd.isCursor());
+  assertFalse(lcd.isBlink());
+}
+
+unittest_main()
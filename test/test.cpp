@@ -1,5 +1,10 @@
+#include <algorithm>
 #include <bitset>
+#include <fcntl.h>
 #include <iostream>
+#include <thread>
+#include <sys/mman.h>
+#include <unistd.h>
 #include <vector>
 
 #include "ArduinoUnitTests.h"
@@ -813,6 +818,10 @@ unittest(display_high) {
   lcd.noDisplay();
   isDisplay = lcd.isDisplay();
   assertEqual(0, isDisplay);
+
+  // begin() turns it back on, as LiquidCrystal's does
+  lcd.begin(16, 2);
+  assertTrue(lcd.isDisplay());
 }
 
 unittest(blink_high) {
@@ -903,4 +912,286 @@ unittest(createChar_and_print) {
   assertEqual(0, lines.at(1).length());
 }
 
+unittest(lazy_matches_eager) {
+  LiquidCrystal_CI eager(rs, enable, d4, d5, d6, d7);
+  LiquidCrystal_CI lazy(rw, enable, d4, d5, d6, d7);
+  lazy.setLazy(true);
+  assertTrue(lazy.isLazy());
+  LiquidCrystal_CI *lcds[] = {&eager, &lazy};
+  for (int i = 0; i < 2; ++i) {
+    LiquidCrystal_CI *lcd = lcds[i];
+    lcd->begin(16, 2);
+    lcd->print("Hello");
+    lcd->setCursor(2, 1);
+    lcd->print(42);
+    lcd->home();
+    lcd->print("J");
+    lcd->setCursor(16, 1);
+    lcd->autoscroll();
+    lcd->print("ab");
+    lcd->noAutoscroll();
+  }
+  assertTrue(eager.getLines() == lazy.getLines());
+  assertEqual("Jello", lazy.getLines().at(0));
+  assertEqual("42            ab", lazy.getLines().at(1));
+  assertEqual(eager.getCursorCol(), lazy.getCursorCol());
+  assertEqual(eager.getCursorRow(), lazy.getCursorRow());
+  assertFalse(lazy.isAutoscroll());
+}
+
+unittest(lazy_query_between_prints) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.setLazy(true);
+  lcd.begin(16, 2);
+  lcd.print("one");
+  assertEqual("one", lcd.getLines().at(0));
+  assertEqual(3, lcd.getCursorCol());
+  lcd.clear();
+  lcd.home();
+  lcd.print("two");
+  assertEqual("two", lcd.getLines().at(0));
+  lcd.setLazy(false);
+  lcd.print("!");
+  assertEqual("two!", lcd.getLines().at(0));
+}
+
+unittest(lazy_skips_the_bus) {
+  LiquidCrystal_CI eager(rs, enable, d4, d5, d6, d7);
+  LiquidCrystal_CI lazy(rw, enable, d4, d5, d6, d7);
+  lazy.setLazy(true, true);
+  unsigned long took[2];
+  bool quiet[2];
+  LiquidCrystal_CI *lcds[] = {&eager, &lazy};
+  for (int i = 0; i < 2; ++i) {
+    lcds[i]->begin(16, 2);
+    // sent over the pins, which times a write
+    lcds[i]->print("Hi");
+    BitCollector pinValues(false);
+    unsigned long start = micros();
+    lcds[i]->print(" there");
+    took[i] = micros() - start;
+    quiet[i] = pinValues.isEqualTo(vector<int>());
+  }
+  assertFalse(quiet[0]);
+  assertTrue(quiet[1]);
+  assertEqual(took[0], took[1]);
+  assertTrue(eager.getLines() == lazy.getLines());
+  assertEqual(8, lazy.getCursorCol());
+}
+
+unittest(lazy_pending_is_bounded) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.setLazy(true);
+  lcd.begin(16, 2);
+  for (int i = 0; i < 1000; ++i) {
+    lcd.setCursor(0, 1);
+    lcd.print(i);
+  }
+  assertMoreOrEqual(LiquidCrystal_CI::LAZY_LIMIT, lcd.getPendingCount());
+  assertEqual("999", lcd.getLines().at(1));
+  assertEqual(0, lcd.getPendingCount());
+}
+
+unittest(clone_from_prototype) {
+  LiquidCrystal_CI prototype(rs, enable, d4, d5, d6, d7);
+  prototype.begin(16, 2);
+  prototype.print("Ready");
+  prototype.blink();
+
+  BitCollector pinValues(false);
+  unsigned long start = GODMODE()->micros;
+  LiquidCrystal_CI lcd(prototype);
+  assertTrue(pinValues.isEqualTo(vector<int>()));
+  assertEqual(start, GODMODE()->micros);
+  assertEqual(&lcd, LiquidCrystal_CI::forRsPin(rs));
+
+  assertEqual(2, lcd.getRows());
+  assertEqual("Ready", lcd.getLines().at(0));
+  assertEqual(5, lcd.getCursorCol());
+  assertTrue(lcd.isBlink());
+
+  // the copy is independent of the prototype, on the bus and in the shadow
+  vector<int> expected{608, 640};
+  lcd.print("h");
+  assertTrue(pinValues.isEqualTo(expected));
+  assertEqual("Readyh", lcd.getLines().at(0));
+  assertEqual("Ready", prototype.getLines().at(0));
+}
+
+unittest(clone_replayInit) {
+  vector<int> expected{48, 48, 48, 32, 32, 0, 0, 192, 0, 16, 0, 96};
+  LiquidCrystal_CI prototype(rs, enable, d4, d5, d6, d7);
+  LiquidCrystal_CI *lcd = new LiquidCrystal_CI(prototype);
+  BitCollector pinValues(false); // test the next line
+  lcd->replayInit();
+  assertTrue(pinValues.isEqualTo(expected));
+  delete lcd;
+  // the prototype has the pin back
+  assertEqual(&prototype, LiquidCrystal_CI::forRsPin(rs));
+}
+
+unittest(clone_outlives_prototype) {
+  LiquidCrystal_CI *prototype =
+      new LiquidCrystal_CI(rs, enable, d4, d5, d6, d7);
+  LiquidCrystal_CI *first = new LiquidCrystal_CI(*prototype);
+  LiquidCrystal_CI *second = new LiquidCrystal_CI(*first);
+  assertEqual(second, LiquidCrystal_CI::forRsPin(rs));
+  delete first;
+  assertEqual(second, LiquidCrystal_CI::forRsPin(rs));
+  delete second;
+  assertEqual(prototype, LiquidCrystal_CI::forRsPin(rs));
+  second = new LiquidCrystal_CI(*prototype);
+  delete prototype;
+  delete second;
+  assertNull(LiquidCrystal_CI::forRsPin(rs));
+}
+
+unittest(concurrent_defers_until_applied) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  lcd.setConcurrent(true, 4096, true);
+  assertTrue(lcd.isConcurrent());
+  BitCollector pinValues(false);
+  lcd.print("Hi");
+  lcd.blink();
+  // queued, not yet on the bus
+  assertTrue(pinValues.isEqualTo(vector<int>()));
+  lcd.applyPending();
+  vector<int> expected{576, 640, 608, 656, 0, 208};
+  assertTrue(pinValues.isEqualTo(expected));
+  assertEqual("Hi", lcd.getLines().at(0));
+  assertTrue(lcd.isBlink());
+  assertEqual(3, lcd.getInterleaving().size());
+  lcd.setConcurrent(false);
+  lcd.print("!");
+  assertEqual("Hi!", lcd.getLines().at(0));
+  // without recording, nothing is kept
+  lcd.setConcurrent(true);
+  lcd.print("?");
+  lcd.applyPending();
+  assertEqual("Hi!?", lcd.getLines().at(0));
+  assertEqual(0, lcd.getInterleaving().size());
+  lcd.setConcurrent(false);
+}
+
+unittest(concurrent_tasks) {
+  const int tasks = 4;
+  const int count = 2000;
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(20, 4);
+  // a small queue, so producers also have to apply calls themselves
+  lcd.setConcurrent(true, 64, true);
+  std::vector<std::thread> threads;
+  for (int task = 0; task < tasks; ++task) {
+    threads.push_back(std::thread([&lcd, task, count]() {
+      LiquidCrystal_CI::setTask(task + 1);
+      for (int i = 0; i < count; ++i) {
+        lcd.setCursor(i % 20, task);
+        lcd.write('A' + task);
+      }
+    }));
+  }
+  for (int task = 0; task < tasks; ++task) {
+    threads.at(task).join();
+  }
+  std::vector<LiquidCrystal_CI::TaskCall> calls = lcd.getInterleaving();
+  assertEqual(tasks * count * 2, calls.size());
+  for (int task = 0; task < tasks; ++task) {
+    String output = lcd.getTaskOutput(task + 1);
+    assertEqual(count, output.length());
+    assertEqual(count, std::count(output.begin(), output.end(), 'A' + task));
+  }
+  // every row holds characters from some task, and nothing else
+  std::vector<String> lines = lcd.getLines();
+  for (size_t row = 0; row < lines.size(); ++row) {
+    for (size_t col = 0; col < lines.at(row).length(); ++col) {
+      char c = lines.at(row).at(col);
+      assertTrue(c == ' ' || (c >= 'A' && c < 'A' + tasks));
+    }
+  }
+}
+
+unittest(publish_framebuffer) {
+  char path[] = "/tmp/lcd_fb_XXXXXX";
+  int fd = mkstemp(path);
+  assertNotEqual(-1, fd);
+  close(fd);
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  assertTrue(lcd.publishTo(path));
+
+  // map it separately, as a viewer would
+  fd = open(path, O_RDONLY);
+  void *mapped =
+      mmap(nullptr, sizeof(LCDFramebuffer), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  assertTrue(mapped != MAP_FAILED);
+  const LCDFramebuffer *framebuffer = (const LCDFramebuffer *)mapped;
+  assertTrue(framebuffer->isValid());
+
+  byte smiley[8] = {B00000, B10001, B00000, B00000,
+                    B10001, B01110, B00000, B00000};
+  lcd.createChar(3, smiley);
+  lcd.setCursor(0, 0);
+  lcd.print("Hello");
+  lcd.setCursor(2, 1);
+  lcd.write(3);
+  lcd.display();
+  lcd.blink();
+
+  LCDFrame frame;
+  uint32_t sequence = framebuffer->read(&frame);
+  assertEqual(0, sequence & 1);
+  assertEqual(16, frame.cols);
+  assertEqual(2, frame.rows);
+  assertEqual(rs, frame.rsPin);
+  assertEqual(3, frame.cursorCol);
+  assertEqual(1, frame.cursorRow);
+  assertEqual(LCD_FRAME_DISPLAY | LCD_FRAME_BLINK, frame.flags);
+  assertEqual(0, memcmp(frame.grid[0], "Hello           ", 16));
+  assertEqual(0, memcmp(frame.grid[1], "  \x03             ", 16));
+  assertEqual(0, memcmp(frame.cgram[3], smiley, 8));
+  // one update per call: begin() is before publishing
+  assertEqual(1 + 1 + 1 + 5 + 1 + 1 + 1 + 1, frame.updates);
+
+  lcd.stopPublishing();
+  lcd.print("!");
+  assertEqual(sequence, framebuffer->read(&frame));
+  munmap(mapped, sizeof(LCDFramebuffer));
+  unlink(path);
+}
+
+// records the first line after each update
+class LineRecorder : public LiquidCrystal_CI::Listener {
+public:
+  vector<String> seen;
+  virtual void onUpdate(LiquidCrystal_CI &lcd) {
+    seen.push_back(lcd.getLines().at(0));
+  }
+};
+
+unittest(listeners_see_every_update) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LineRecorder recorder;
+  lcd.addListener(&recorder);
+  lcd.setLazy(true);
+  lcd.print("ab");
+  lcd.setLazy(false);
+  assertEqual(2, recorder.seen.size());
+  assertEqual("a", recorder.seen.at(0));
+  assertEqual("ab", recorder.seen.at(1));
+
+  // from the applier, which already holds the lock the accessors take
+  lcd.setConcurrent(true);
+  lcd.print("c");
+  lcd.applyPending();
+  assertEqual("abc", recorder.seen.back());
+  lcd.setConcurrent(false);
+
+  lcd.removeListener(&recorder);
+  lcd.print("d");
+  assertEqual(3, recorder.seen.size());
+}
+
 unittest_main()
@@ -0,0 +1,226 @@
+#include "ArduinoUnitTests.h"
+
+#include "LiquidCrystal_CI.h"
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+const byte rs = 1;
+const byte enable = 3;
+const byte d4 = 14;
+const byte d5 = 15;
+const byte d6 = 16;
+const byte d7 = 17;
+
+struct Event {
+  String name, category;
+  unsigned long start, duration, track;
+};
+
+// the events of a trace, one per line as LCDTraceWriter writes them
+std::vector<Event> readTrace(const char *path, String *text) {
+  std::vector<Event> events;
+  FILE *file = fopen(path, "r");
+  char line[512];
+  while (file && fgets(line, sizeof(line), file)) {
+    *text += line;
+    char name[64], category[64];
+    Event event;
+    if (sscanf(line,
+               "{\"ph\":\"X\",\"name\":\"%63[^\"]\",\"cat\":\"%63[^\"]\","
+               "\"ts\":%lu,\"dur\":%lu,\"pid\":1,\"tid\":%lu",
+               name, category, &event.start, &event.duration,
+               &event.track) == 5) {
+      event.name = name;
+      event.category = category;
+      events.push_back(event);
+    }
+  }
+  if (file) {
+    fclose(file);
+  }
+  return events;
+}
+
+int countEvents(const std::vector<Event> &events, const char *name) {
+  int count = 0;
+  for (size_t i = 0; i < events.size(); ++i) {
+    count += events[i].name == name;
+  }
+  return count;
+}
+
+unittest(calls_nest_transfers_and_delays) {
+  char path[] = "/tmp/lcd_trace_XXXXXX";
+  close(mkstemp(path));
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LCDTraceWriter trace;
+  assertTrue(trace.open(path));
+  lcd.traceTo(&trace);
+  {
+    LCDTraceWriter::Span span(trace, "loop");
+    lcd.setCursor(2, 1);
+    lcd.print("ab");
+    lcd.clear();
+  }
+  lcd.traceTo(nullptr);
+  lcd.print("c");
+  trace.close();
+
+  String text;
+  std::vector<Event> events = readTrace(path, &text);
+  assertEqual(0, text.indexOf("{\"traceEvents\":["));
+  assertTrue(text.endsWith("\n]}\n"));
+  assertTrue(text.indexOf("\"args\":{\"name\":\"LCD enable 3\"}") > 0);
+  // print() is one call, not one per character; 4-bit mode sends nibbles
+  assertEqual(1, countEvents(events, "setCursor"));
+  assertEqual(1, countEvents(events, "print"));
+  assertEqual(0, countEvents(events, "write"));
+  assertEqual(1, countEvents(events, "clear"));
+  assertEqual(4, countEvents(events, "instruction"));
+  assertEqual(4, countEvents(events, "data"));
+  assertEqual(1, countEvents(events, "loop"));
+
+  // every transfer and delay lies within a call, and the calls fill the
+  // loop's span
+  unsigned long busy = 0;
+  const Event *loop = nullptr;
+  for (size_t i = 0; i < events.size(); ++i) {
+    const Event &event = events[i];
+    if (event.category == "sketch") {
+      loop = &event;
+      continue;
+    }
+    assertEqual(enable, event.track);
+    if (event.category == "call") {
+      busy += event.duration;
+      continue;
+    }
+    bool inside = false;
+    for (size_t j = 0; j < events.size(); ++j) {
+      const Event &call = events[j];
+      if (call.category == "call" && call.start <= event.start &&
+          event.start + event.duration <= call.start + call.duration) {
+        inside = true;
+      }
+    }
+    assertTrue(inside);
+  }
+  assertNotNull(loop);
+  assertEqual(loop->duration, busy);
+  unlink(path);
+}
+
+unittest(long_traces_are_streamed) {
+  char path[] = "/tmp/lcd_trace_XXXXXX";
+  close(mkstemp(path));
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LCDTraceWriter trace;
+  assertEqual(0, trace.getEvents());
+  assertEqual(0, trace.getBytes());
+  assertTrue(trace.open(path));
+  lcd.traceTo(&trace);
+  for (int i = 0; i < 1000; ++i) {
+    lcd.setCursor(0, 0);
+    lcd.write('x');
+  }
+  assertMore(trace.getBytes(), LCDTraceWriter::BUFFER_SIZE);
+  // setCursor and write, each with two transfers and three delays: before,
+  // between and after the pulses
+  assertEqual(1 + 1000 * 2 * 6, trace.getEvents());
+  trace.close();
+  FILE *file = fopen(path, "r");
+  fseek(file, 0, SEEK_END);
+  assertEqual(trace.getBytes(), ftell(file));
+  fclose(file);
+  unlink(path);
+
+  // quotes and control characters in names are escaped
+  assertTrue(trace.open(path));
+  trace.complete("say \"hi\"\n", "sketch", 0, 1);
+  trace.close();
+  String text;
+  readTrace(path, &text);
+  assertTrue(text.indexOf("\"say \\\"hi\\\"\\u000a\"") > 0);
+  unlink(path);
+}
+
+unittest(displays_sharing_rs_get_their_own_tracks) {
+  const byte enable2 = 4;
+  char path[] = "/tmp/lcd_trace_XXXXXX";
+  close(mkstemp(path));
+  LiquidCrystal_CI top(rs, enable, d4, d5, d6, d7);
+  LiquidCrystal_CI bottom(rs, enable2, d4, d5, d6, d7);
+  top.begin(16, 2);
+  bottom.begin(16, 2);
+  LCDTraceWriter trace;
+  assertTrue(trace.open(path));
+  top.traceTo(&trace);
+  bottom.traceTo(&trace);
+  top.print("a");
+  bottom.print("bc");
+  top.traceTo(nullptr);
+  bottom.traceTo(nullptr);
+  trace.close();
+
+  String text;
+  std::vector<Event> events = readTrace(path, &text);
+  assertTrue(text.indexOf("\"args\":{\"name\":\"LCD enable 3\"}") > 0);
+  assertTrue(text.indexOf("\"args\":{\"name\":\"LCD enable 4\"}") > 0);
+  int data[2] = {0, 0};
+  for (size_t i = 0; i < events.size(); ++i) {
+    if (events[i].name == "data") {
+      assertTrue(events[i].track == enable || events[i].track == enable2);
+      ++data[events[i].track == enable2];
+    }
+  }
+  // two nibbles per character
+  assertEqual(2, data[0]);
+  assertEqual(4, data[1]);
+  unlink(path);
+}
+
+unittest(concurrent_calls_are_traced_when_applied) {
+  const int tasks = 4;
+  const int count = 100;
+  char path[] = "/tmp/lcd_trace_XXXXXX";
+  close(mkstemp(path));
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 4);
+  LCDTraceWriter trace;
+  assertTrue(trace.open(path));
+  lcd.traceTo(&trace);
+  lcd.setConcurrent(true, 64);
+  std::vector<std::thread> threads;
+  for (int task = 0; task < tasks; ++task) {
+    threads.push_back(std::thread([&lcd, task, count]() {
+      for (int i = 0; i < count; ++i) {
+        lcd.setCursor(i % 16, task);
+        lcd.print("x");
+      }
+    }));
+  }
+  for (int task = 0; task < tasks; ++task) {
+    threads.at(task).join();
+  }
+  lcd.applyPending();
+  lcd.traceTo(nullptr);
+  trace.close();
+
+  String text;
+  std::vector<Event> events = readTrace(path, &text);
+  // print() is queued a character at a time, so it is traced as writes
+  assertEqual(tasks * count, countEvents(events, "setCursor"));
+  assertEqual(tasks * count, countEvents(events, "write"));
+  assertEqual(0, countEvents(events, "print"));
+  assertEqual(2 * tasks * count, countEvents(events, "instruction"));
+  assertEqual(2 * tasks * count, countEvents(events, "data"));
+  lcd.setConcurrent(false);
+  unlink(path);
+}
+
+unittest_main()
@@ -0,0 +1,120 @@
+#include "ArduinoUnitTests.h"
+#include "PulseCounter.h"
+
+#include "LCDWidgets.h"
+
+unittest(number_field_formats) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LCDNumberField plain(lcd, 0, 0, 5);
+  LCDNumberField fixed(lcd, 6, 0, 6, 2);
+  LCDNumberField narrow(lcd, 0, 1, 3);
+
+  plain.set(42);
+  fixed.set(-1234);
+  narrow.set(-7);
+  assertEqual("   42 -12.34", lcd.getLines().at(0));
+  assertEqual(" -7", lcd.getLines().at(1));
+  fixed.set(5);
+  narrow.set(1000);
+  assertEqual("   42   0.05", lcd.getLines().at(0));
+  assertEqual("***", lcd.getLines().at(1));
+  narrow.set(-99);
+  assertEqual("-99", lcd.getLines().at(1));
+  narrow.set(-100);
+  assertEqual("***", lcd.getLines().at(1));
+  plain.set(0);
+  assertEqual("    0   0.05", lcd.getLines().at(0));
+}
+
+unittest(number_field_rewrites_only_changed_digits) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LCDNumberField field(lcd, 2, 1, 6);
+  PulseCounter counter;
+
+  field.set(123456);
+  // setCursor and six digits
+  assertEqual(2 * (1 + 6), counter.pulses);
+  counter.pulses = 0;
+  field.set(123456);
+  assertEqual(0, counter.pulses);
+  field.set(123457);
+  assertEqual(2 * (1 + 1), counter.pulses);
+  counter.pulses = 0;
+  // two changes one cell apart are sent as one run of three
+  field.set(123557);
+  assertEqual(2 * (1 + 1), counter.pulses);
+  counter.pulses = 0;
+  field.set(124547);
+  assertEqual(2 * (1 + 3), counter.pulses);
+  counter.pulses = 0;
+  // further apart, two runs
+  field.set(224548);
+  assertEqual(2 * (2 + 2), counter.pulses);
+  assertEqual("  224548", lcd.getLines().at(1));
+
+  counter.pulses = 0;
+  lcd.clear();
+  field.invalidate();
+  field.set(224548);
+  assertEqual(2 * (1 + 1 + 6), counter.pulses);
+  assertEqual("  224548", lcd.getLines().at(1));
+}
+
+unittest(bar_graph_draws_partial_blocks) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LCDBarGraph bar(lcd, 0, 1, 10, 4);
+  bar.begin();
+  assertEqual(50, bar.getMaximum());
+  assertEqual(B11100, lcd.getCustomCharacter(6)[0]);
+
+  bar.set(13);
+  std::vector<String> lines = lcd.getLines();
+  assertEqual(10, lines.at(1).length());
+  assertEqual(LCDBarGraph::FULL_BLOCK, (uint8_t)lines.at(1)[0]);
+  assertEqual(LCDBarGraph::FULL_BLOCK, (uint8_t)lines.at(1)[1]);
+  assertEqual(6, lines.at(1)[2]);
+  assertEqual(' ', lines.at(1)[3]);
+  // 38 of 50
+  bar.set(3, 4);
+  lines = lcd.getLines();
+  assertEqual(LCDBarGraph::FULL_BLOCK, (uint8_t)lines.at(1)[6]);
+  assertEqual(6, lines.at(1)[7]);
+  assertEqual(' ', lines.at(1)[8]);
+  bar.set(5, 4);
+  assertEqual(LCDBarGraph::FULL_BLOCK, (uint8_t)lcd.getLines().at(1)[9]);
+}
+
+unittest(bar_graph_rewrites_only_the_boundary) {
+  LiquidCrystal_CI lcd(rs, enable, d4, d5, d6, d7);
+  lcd.begin(16, 2);
+  LCDBarGraph bar(lcd, 0, 0, 16);
+  bar.begin();
+  bar.set(40);
+  PulseCounter counter;
+
+  // within one cell: setCursor and that cell
+  for (int level = 41; level <= 44; ++level) {
+    counter.pulses = 0;
+    bar.set(level);
+    assertEqual(2 * (1 + 1), counter.pulses);
+  }
+  counter.pulses = 0;
+  bar.set(44);
+  assertEqual(0, counter.pulses);
+  // crossing into the next cell touches both
+  bar.set(46);
+  assertEqual(2 * (1 + 2), counter.pulses);
+  // a full redraw would have been setCursor and 16 cells
+  counter.pulses = 0;
+  bar.set(30);
+  assertEqual(2 * (1 + 4), counter.pulses);
+  std::vector<String> lines = lcd.getLines();
+  assertEqual(LCDBarGraph::FULL_BLOCK, (uint8_t)lines.at(0)[5]);
+  assertEqual(' ', lines.at(0)[6]);
+  assertEqual(' ', lines.at(0)[9]);
+}
+
+unittest_main()